@@ -44,5 +44,7 @@ int main() {
 
     printf("#define CONFIG_REMIO_DEV_NUM %ld\n", remio_dev_num());
 
+    printf("#define CONFIG_SHMEM_NUM %ld\n", config.shmemlist_size ? config.shmemlist_size : 1);
+
     return 0;
  }
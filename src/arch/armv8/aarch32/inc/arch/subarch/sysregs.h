@@ -99,6 +99,9 @@ SYSREG_GEN_ACCESSORS(prselr_el2, 4, c6, c2, 1)
 SYSREG_GEN_ACCESSORS(prbar_el2, 4, c6, c3, 0)
 SYSREG_GEN_ACCESSORS(prlar_el2, 4, c6, c3, 1)
 SYSREG_GEN_ACCESSORS(prenr_el2, 4, c6, c1, 1)
+SYSREG_GEN_ACCESSORS(mpuir_el1, 0, c0, c0, 4)
+SYSREG_GEN_ACCESSORS(prselr_el1, 0, c6, c2, 1)
+SYSREG_GEN_ACCESSORS(prlar_el1, 0, c6, c3, 1)
 
 SYSREG_GEN_ACCESSORS(ich_misr_el2, 4, c12, c11, 2)
 SYSREG_GEN_ACCESSORS(ich_eisr_el2, 4, c12, c11, 3)
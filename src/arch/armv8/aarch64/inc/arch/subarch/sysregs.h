@@ -13,6 +13,9 @@
 #define prbar_el2       S3_4_C6_C8_0
 #define prlar_el2       S3_4_C6_C8_1
 #define prenr_el2       S3_4_C6_C1_1
+#define mpuir_el1       S3_0_C0_C0_4
+#define prselr_el1      S3_0_C6_C2_1
+#define prlar_el1       S3_0_C6_C8_1
 #define ich_misr_el2    S3_4_C12_C11_2
 #define ich_eisr_el2    S3_4_C12_C11_3
 #define ich_elrsr_el2   S3_4_C12_C11_5
@@ -94,6 +97,9 @@ SYSREG_GEN_ACCESSORS(prselr_el2)
 SYSREG_GEN_ACCESSORS(prbar_el2)
 SYSREG_GEN_ACCESSORS(prlar_el2)
 SYSREG_GEN_ACCESSORS(prenr_el2)
+SYSREG_GEN_ACCESSORS(mpuir_el1)
+SYSREG_GEN_ACCESSORS(prselr_el1)
+SYSREG_GEN_ACCESSORS(prlar_el1)
 SYSREG_GEN_ACCESSORS(ich_misr_el2)
 SYSREG_GEN_ACCESSORS(ich_eisr_el2)
 SYSREG_GEN_ACCESSORS(ich_elrsr_el2)
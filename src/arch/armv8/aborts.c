@@ -14,11 +14,43 @@
 
 typedef void (*abort_handler_t)(unsigned long, unsigned long, unsigned long, unsigned long);
 
+/**
+ * On MPU-based platforms, a guest access may fault just because its region was evicted from the
+ * physical MPU. In that case the region is re-installed and the access is simply retried.
+ */
+static bool aborts_demand_map(unsigned long addr)
+{
+#ifdef MEM_PROT_MPU
+    return mem_demand_map(&cpu()->vcpu->vm->as, (vaddr_t)addr);
+#else
+    UNUSED_ARG(addr);
+    return false;
+#endif
+}
+
+static void aborts_ins_lower(unsigned long iss, unsigned long far, unsigned long il,
+    unsigned long ec)
+{
+    UNUSED_ARG(iss);
+    UNUSED_ARG(il);
+    UNUSED_ARG(ec);
+
+    if (!aborts_demand_map(far)) {
+        ERROR("no handler for instruction abort (0x%x)\n", far);
+    }
+}
+
 static void aborts_data_lower(unsigned long iss, unsigned long far, unsigned long il,
     unsigned long ec)
 {
     UNUSED_ARG(ec);
 
+    vaddr_t addr = far;
+    emul_handler_t handler = vm_emul_get_mem(cpu()->vcpu->vm, addr);
+    if ((handler == NULL) && aborts_demand_map(far)) {
+        return;
+    }
+
     if (!(iss & ESR_ISS_DA_ISV_BIT) || (iss & ESR_ISS_DA_FnV_BIT)) {
         ERROR("no information to handle data abort (0x%x)\n", far);
     }
@@ -29,8 +61,6 @@ static void aborts_data_lower(unsigned long iss, unsigned long far, unsigned lon
         ERROR("data abort is not translation fault - cant deal with it\n");
     }
 
-    vaddr_t addr = far;
-    emul_handler_t handler = vm_emul_get_mem(cpu()->vcpu->vm, addr);
     if (handler != NULL) {
         struct emul_access emul;
         emul.addr = addr;
@@ -100,11 +130,6 @@ static inline void syscall_handler(unsigned long iss, unsigned long far, unsigne
     vcpu_writereg(cpu()->vcpu, 0, (unsigned long)ret);
 }
 
-static void hvc_handler(unsigned long iss, unsigned long far, unsigned long il, unsigned long ec)
-{
-    syscall_handler(iss, far, il, ec);
-}
-
 static void smc_handler(unsigned long iss, unsigned long far, unsigned long il, unsigned long ec)
 {
     UNUSED_ARG(far);
@@ -165,19 +190,32 @@ static void sysreg_handler(unsigned long iss, unsigned long far, unsigned long i
 }
 
 abort_handler_t abort_handlers[64] = {
+    [ESR_EC_IALEL] = aborts_ins_lower,
     [ESR_EC_DALEL] = aborts_data_lower,
     [ESR_EC_SMC32] = smc_handler,
     [ESR_EC_SMC64] = smc_handler,
     [ESR_EC_SYSRG] = sysreg_handler,
     [ESR_EC_RG_32] = sysreg_handler,
     [ESR_EC_RG_64] = sysreg_handler,
-    [ESR_EC_HVC32] = hvc_handler,
-    [ESR_EC_HVC64] = hvc_handler,
 };
 
 void aborts_sync_handler(void)
 {
     unsigned long esr = sysreg_esr_el2_read();
+    unsigned long ec = bit_extract(esr, ESR_EC_OFF, ESR_EC_LEN);
+
+    /**
+     * Hypercalls are the most frequent synchronous guest exit and carry no fault information.
+     * Dispatch them before decoding the fault address syndrome registers.
+     */
+    if (ec == ESR_EC_HVC64 || ec == ESR_EC_HVC32) {
+        syscall_handler(0, 0, 0, ec);
+        if (vcpu_arch_is_on(cpu()->vcpu) && !cpu()->vcpu->active) {
+            cpu_standby();
+        }
+        return;
+    }
+
     unsigned long far = sysreg_far_el2_read();
     unsigned long hpfar = sysreg_hpfar_el2_read();
     unsigned long ipa_fault_addr = 0;
@@ -188,7 +226,6 @@ void aborts_sync_handler(void)
         ipa_fault_addr = far;
     }
 
-    unsigned long ec = bit_extract(esr, ESR_EC_OFF, ESR_EC_LEN);
     unsigned long il = bit_extract(esr, ESR_IL_OFF, ESR_IL_LEN);
     unsigned long iss = bit_extract(esr, ESR_ISS_OFF, ESR_ISS_LEN);
 
@@ -18,3 +18,8 @@ void vm_arch_profile_init(struct vm* vm)
     ISB(); // make sure vmid is commited befor tlbi
     tlb_vm_inv_all(vm->id);
 }
+
+void vcpu_arch_profile_reset(struct vcpu* vcpu)
+{
+    UNUSED_ARG(vcpu);
+}
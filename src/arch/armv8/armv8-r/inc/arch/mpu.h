@@ -15,7 +15,21 @@ struct mpu_arch {
     BITMAP_ALLOC(allocated_entries, MPU_ARCH_MAX_NUM_ENTRIES);
     BITMAP_ALLOC(locked_entries, MPU_ARCH_MAX_NUM_ENTRIES);
     asid_t entry_asid[MPU_ARCH_MAX_NUM_ENTRIES];
+    /**
+     * Shadow of each entry's PRBAR and PRLAR, so lookups do not have to select and read back
+     * entries and writes that would not change an entry are skipped.
+     */
+    unsigned long entry_prbar[MPU_ARCH_MAX_NUM_ENTRIES];
+    unsigned long entry_prlar[MPU_ARCH_MAX_NUM_ENTRIES];
     unsigned long mpu_entry_mask;
+    size_t num_entries;
+    /**
+     * VM regions are demand-paged into the hardware MPU when the vMPU holds more regions than
+     * there are free entries. Unlocked VM entries are evicted round-robin starting at evict_next.
+     */
+    mpid_t evict_next;
+    unsigned long demand_faults;
+    unsigned long evictions;
 };
 
 #endif /* __ARCH_MPU_H__ */
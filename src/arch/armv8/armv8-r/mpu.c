@@ -8,17 +8,7 @@
 #include <vm.h>
 #include <arch/sysregs.h>
 #include <arch/fences.h>
-
-static unsigned long mpu_get_region_base(mpid_t mpid)
-{
-    unsigned long prbar = 0;
-
-    sysreg_prselr_el2_write(mpid);
-    ISB();
-    prbar = sysreg_prbar_el2_read();
-
-    return PRBAR_BASE(prbar);
-}
+#include <stats.h>
 
 static mpid_t mpu_find_region(struct mp_region* mpr, asid_t asid)
 {
@@ -26,7 +16,7 @@ static mpid_t mpu_find_region(struct mp_region* mpr, asid_t asid)
 
     for (mpid_t i = 0; i < MPU_ARCH_MAX_NUM_ENTRIES; i++) {
         if (bitmap_get(cpu()->arch.profile.mpu.allocated_entries, i)) {
-            if (mpu_get_region_base(i) == mpr->base &&
+            if (PRBAR_BASE(cpu()->arch.profile.mpu.entry_prbar[i]) == mpr->base &&
                 cpu()->arch.profile.mpu.entry_asid[i] == asid) {
                 mpid = i;
                 break;
@@ -40,10 +30,12 @@ static mpid_t mpu_entry_allocate(asid_t asid)
 {
     mpid_t reg_num = INVALID_MPID;
     reg_num = (mpid_t)bitmap_find_nth(cpu()->arch.profile.mpu.allocated_entries,
-        MPU_ARCH_MAX_NUM_ENTRIES, 1, 0, BITMAP_NOT_SET);
+        cpu()->arch.profile.mpu.num_entries, 1, 0, BITMAP_NOT_SET);
 
-    bitmap_set(cpu()->arch.profile.mpu.allocated_entries, reg_num);
-    cpu()->arch.profile.mpu.entry_asid[reg_num] = asid;
+    if (reg_num != INVALID_MPID) {
+        bitmap_set(cpu()->arch.profile.mpu.allocated_entries, reg_num);
+        cpu()->arch.profile.mpu.entry_asid[reg_num] = asid;
+    }
 
     return reg_num;
 }
@@ -64,34 +56,54 @@ static inline void mpu_entry_unlock(mpid_t mpid)
     bitmap_clear(cpu()->arch.profile.mpu.locked_entries, mpid);
 }
 
-static void mpu_entry_set(mpid_t mpid, struct mp_region* mpr)
+static void mpu_entry_write(mpid_t mpid, unsigned long prbar, unsigned long prlar)
 {
-    unsigned long lim = mpr->base + mpr->size - 1;
+    struct mpu_arch* mpu = &cpu()->arch.profile.mpu;
+    bool prbar_changed = mpu->entry_prbar[mpid] != prbar;
+    bool prlar_changed = mpu->entry_prlar[mpid] != prlar;
+
+    if (!prbar_changed && !prlar_changed) {
+        return;
+    }
 
     sysreg_prselr_el2_write(mpid);
     ISB();
-    sysreg_prbar_el2_write((mpr->base & PRBAR_BASE_MSK) | mpr->mem_flags.prbar);
-    sysreg_prlar_el2_write((lim & PRLAR_LIMIT_MSK) | mpr->mem_flags.prlar);
+    if (prlar_changed && (prlar == 0)) {
+        /* Disable the entry before touching its base */
+        sysreg_prlar_el2_write(prlar);
+        prlar_changed = false;
+    }
+    if (prbar_changed) {
+        sysreg_prbar_el2_write(prbar);
+    }
+    if (prlar_changed) {
+        sysreg_prlar_el2_write(prlar);
+    }
     ISB();
+
+    mpu->entry_prbar[mpid] = prbar;
+    mpu->entry_prlar[mpid] = prlar;
+}
+
+static void mpu_entry_set(mpid_t mpid, struct mp_region* mpr)
+{
+    unsigned long lim = mpr->base + mpr->size - 1;
+
+    mpu_entry_write(mpid, (mpr->base & PRBAR_BASE_MSK) | mpr->mem_flags.prbar,
+        (lim & PRLAR_LIMIT_MSK) | mpr->mem_flags.prlar);
 }
 
 static void mpu_entry_update_limit(mpid_t mpid, struct mp_region* mpr)
 {
     unsigned long lim = mpr->base + mpr->size - 1;
 
-    sysreg_prselr_el2_write(mpid);
-    ISB();
-    sysreg_prlar_el2_write((lim & PRLAR_LIMIT_MSK) | mpr->mem_flags.prlar);
-    ISB();
+    mpu_entry_write(mpid, cpu()->arch.profile.mpu.entry_prbar[mpid],
+        (lim & PRLAR_LIMIT_MSK) | mpr->mem_flags.prlar);
 }
 
 static bool mpu_entry_clear(mpid_t mpid)
 {
-    sysreg_prselr_el2_write(mpid);
-    ISB();
-    sysreg_prlar_el2_write(0);
-    sysreg_prbar_el2_write(0);
-    ISB();
+    mpu_entry_write(mpid, 0, 0);
     return true;
 }
 
@@ -106,6 +118,49 @@ static unsigned long* find_mpu_mask_by_asid(asid_t id)
     return mpu_mask;
 }
 
+static mpid_t mpu_entry_evict(asid_t asid)
+{
+    struct mpu_arch* mpu = &cpu()->arch.profile.mpu;
+    unsigned long* mpu_mask = find_mpu_mask_by_asid(asid);
+
+    if (mpu_mask == NULL) {
+        return INVALID_MPID;
+    }
+
+    for (size_t i = 0; i < mpu->num_entries; i++) {
+        mpid_t mpid = (mpu->evict_next + i) % mpu->num_entries;
+        if (bitmap_get(mpu->allocated_entries, mpid) && !bitmap_get(mpu->locked_entries, mpid) &&
+            (mpu->entry_asid[mpid] == asid)) {
+            mpu->evict_next = (mpid + 1) % mpu->num_entries;
+            mpu_entry_deallocate(mpid);
+            mpu_entry_clear(mpid);
+            bitmap_clear((bitmap_t*)mpu_mask, mpid);
+            STATS_INC(mpu->evictions);
+            return mpid;
+        }
+    }
+
+    return INVALID_MPID;
+}
+
+/**
+ * Picks the address space whose unlocked entries may be evicted to make room for a new region.
+ * Demand-paged VM regions are re-installed from the vMPU on their next fault, so both the VM's
+ * own requests and the hypervisor's take entries from the VM currently running on this cpu.
+ */
+static asid_t mpu_evict_asid(struct addr_space* as, bool locked)
+{
+    asid_t asid = INVALID_ASID;
+
+    if ((as->type == AS_VM) && !locked) {
+        asid = as->id;
+    } else if (((as->type == AS_HYP) || (as->type == AS_HYP_CPY)) && (cpu()->vcpu != NULL)) {
+        asid = cpu()->vcpu->vm->as.id;
+    }
+
+    return asid;
+}
+
 bool mpu_map(struct addr_space* as, struct mp_region* mpr, bool locked)
 {
     mpid_t mpid = INVALID_MPID;
@@ -122,6 +177,11 @@ bool mpu_map(struct addr_space* as, struct mp_region* mpr, bool locked)
 
     else {
         mpid = mpu_entry_allocate(as->id);
+        asid_t evict_asid = mpu_evict_asid(as, locked);
+        if ((mpid == INVALID_MPID) && (evict_asid != INVALID_ASID) &&
+            (mpu_entry_evict(evict_asid) != INVALID_MPID)) {
+            mpid = mpu_entry_allocate(as->id);
+        }
         if (mpid != INVALID_MPID) {
             if (locked) {
                 mpu_entry_lock(mpid);
@@ -145,7 +205,29 @@ bool mpu_map(struct addr_space* as, struct mp_region* mpr, bool locked)
         }
     }
 
-    return true;
+    return mpid != INVALID_MPID;
+}
+
+static void mpu_stats_report(void)
+{
+    struct mpu_arch* mpu = &cpu()->arch.profile.mpu;
+    if (stats_report_due(mpu->demand_faults)) {
+        INFO("mpu: cpu %lu demand faults %lu evictions %lu\n", cpu()->id, mpu->demand_faults,
+            mpu->evictions);
+    }
+}
+
+bool mpu_demand_map(struct addr_space* as, struct mp_region* mpr)
+{
+    bool mapped = false;
+
+    if ((as->type == AS_VM) && (mpu_find_region(mpr, as->id) == INVALID_MPID)) {
+        STATS_INC(cpu()->arch.profile.mpu.demand_faults);
+        mapped = mpu_map(as, mpr, false);
+        mpu_stats_report();
+    }
+
+    return mapped;
 }
 
 bool mpu_unmap(struct addr_space* as, struct mp_region* mpr)
@@ -180,7 +262,8 @@ bool mpu_update(struct addr_space* as, struct mp_region* mpr)
         return true;
     }
 
-    return false;
+    /* A VM region evicted from this cpu's MPU is re-installed from the vMPU on its next fault */
+    return as->type == AS_VM;
 }
 
 bool mpu_perms_compatible(unsigned long perms1, unsigned long perms2)
@@ -203,6 +286,17 @@ void mpu_enable(void)
 
 void mpu_init()
 {
+    size_t num_entries = MPUIR_REGION(sysreg_mpuir_el2_read());
+    cpu()->arch.profile.mpu.num_entries = min(num_entries, (size_t)MPU_ARCH_MAX_NUM_ENTRIES);
+    cpu()->arch.profile.mpu.evict_next = 0;
+
+    for (mpid_t mpid = 0; mpid < cpu()->arch.profile.mpu.num_entries; mpid++) {
+        sysreg_prselr_el2_write(mpid);
+        ISB();
+        cpu()->arch.profile.mpu.entry_prbar[mpid] = sysreg_prbar_el2_read();
+        cpu()->arch.profile.mpu.entry_prlar[mpid] = sysreg_prlar_el2_read();
+    }
+
     for (mpid_t mpid = 0; mpid < MPU_ARCH_MAX_NUM_ENTRIES; mpid++) {
         bitmap_clear(cpu()->arch.profile.mpu.allocated_entries, mpid);
         bitmap_clear(cpu()->arch.profile.mpu.locked_entries, mpid);
@@ -6,6 +6,7 @@
 #include <vm.h>
 #include <config.h>
 #include <arch/sysregs.h>
+#include <arch/fences.h>
 
 void vm_arch_profile_init(struct vm* vm)
 {
@@ -16,3 +17,21 @@ void vm_arch_profile_init(struct vm* vm)
         sysreg_vtcr_el2_write(vtcr);
     }
 }
+
+void vcpu_arch_profile_reset(struct vcpu* vcpu)
+{
+    UNUSED_ARG(vcpu);
+
+    /**
+     * The guest owns the EL1 MPU and reprograms it natively: accesses are not trapped, each vcpu
+     * owns its physical cpu so the state is never switched, and the EL2 MPU already bounds whatever
+     * the guest maps. We only make sure a (re)started vcpu does not inherit enabled regions.
+     */
+    unsigned long num_regions = MPUIR_REGION(sysreg_mpuir_el1_read());
+    for (unsigned long i = 0; i < num_regions; i++) {
+        sysreg_prselr_el1_write(i);
+        ISB();
+        sysreg_prlar_el1_write(0);
+    }
+    ISB();
+}
@@ -131,6 +131,21 @@ void gic_send_sgi(cpuid_t cpu_target, irqid_t sgi_num)
     }
 }
 
+void gic_send_sgi_mask(cpumap_t cpu_targets, irqid_t sgi_num)
+{
+    uint32_t trgtlist = 0;
+
+    for (cpuid_t i = 0; i < GIC_MAX_TARGETS; i++) {
+        if (cpu_targets & ((cpumap_t)1 << i)) {
+            trgtlist |= (1U << gic_cpu_map[i]);
+        }
+    }
+
+    if (sgi_num < GIC_MAX_SGIS && trgtlist != 0) {
+        gicd->SGIR = (trgtlist << GICD_SGIR_CPUTRGLST_OFF) | (sgi_num & GICD_SGIR_SGIINTID_MSK);
+    }
+}
+
 static inline uint8_t gic_translate_cpu_to_trgt(uint8_t cpu_targets)
 {
     uint8_t gic_targets = 0;
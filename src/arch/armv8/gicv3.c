@@ -234,6 +234,47 @@ void gic_send_sgi(cpuid_t cpu_target, irqid_t sgi_num)
     sysreg_icc_sgi1r_el1_write(sgi);
 }
 
+/**
+ * Sends an SGI to a set of cpus with a single ICC_SGI1R_EL1 write per affinity cluster, i.e.,
+ * per group of cpus sharing the same Aff2.Aff1 and addressed through the Aff0 target list.
+ */
+void gic_send_sgi_mask(cpumap_t cpu_targets, irqid_t sgi_num)
+{
+    if (sgi_num >= GIC_MAX_SGIS) {
+        return;
+    }
+
+    while (cpu_targets != 0) {
+        uint64_t cluster = 0;
+        uint64_t trgtlist = 0;
+        bool first = true;
+
+        for (cpuid_t i = 0; i < platform.cpu_num; i++) {
+            if (!(cpu_targets & ((cpumap_t)1 << i))) {
+                continue;
+            }
+            uint64_t mpidr = cpu_id_to_mpidr(i);
+            uint64_t aff = (MPIDR_AFF_LVL(mpidr, 2) << ICC_SGIR_AFF2_OFFSET) |
+                (MPIDR_AFF_LVL(mpidr, 1) << ICC_SGIR_AFF1_OFFSET);
+            if (first) {
+                cluster = aff;
+                first = false;
+            }
+            if (aff == cluster) {
+                trgtlist |= (1UL << MPIDR_AFF_LVL(mpidr, 0));
+                cpu_targets &= ~((cpumap_t)1 << i);
+            }
+        }
+
+        if (first) {
+            break;
+        }
+
+        sysreg_icc_sgi1r_el1_write(cluster | ((uint64_t)sgi_num << ICC_SGIR_SGIINTID_OFF) |
+            trgtlist);
+    }
+}
+
 void gic_set_prio(irqid_t int_id, uint8_t prio)
 {
     if (!gic_is_priv(int_id)) {
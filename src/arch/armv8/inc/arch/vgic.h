@@ -50,6 +50,15 @@ struct vgic_int {
     bool enabled;
 };
 
+/**
+ * Physical routing policy for passthrough SPIs the guest configures as 1-of-N (GICv3 IROUTER.IRM).
+ * VGIC_ROUTE_GUEST routes them to the cpu of the vcpu that wrote the IROUTER and relies on vgic
+ * messages to let other vcpus take them. VGIC_ROUTE_SPREAD pins each one to a single vcpu,
+ * round-robin by interrupt id, so no rerouting messages are ever needed. Explicitly targeted
+ * interrupts are always routed directly to the target vcpu's cpu.
+ */
+enum vgic_route_policy { VGIC_ROUTE_GUEST = 0, VGIC_ROUTE_SPREAD };
+
 struct vgicd {
     struct vgic_int* interrupts;
     spinlock_t lock;
@@ -57,6 +66,7 @@ struct vgicd {
     uint32_t CTLR;
     uint32_t TYPER;
     uint32_t IIDR;
+    enum vgic_route_policy route_policy;
 };
 
 struct vgicr {
@@ -66,12 +76,20 @@ struct vgicr {
     uint32_t IIDR;
 };
 
+struct vgic_stats {
+    unsigned long maint_irqs;
+    unsigned long lr_spills;
+    unsigned long lr_refills;
+    unsigned long eoi_deactivates;
+};
+
 struct vgic_priv {
 #if (GIC_VERSION != GICV2)
     struct vgicr vgicr;
 #endif
     irqid_t curr_lrs[GIC_NUM_LIST_REGS];
     struct vgic_int interrupts[GIC_CPU_PRIV];
+    struct vgic_stats stats;
 };
 
 void vgic_init(struct vm* vm, const struct vgic_dscrp* vgic_dscrp);
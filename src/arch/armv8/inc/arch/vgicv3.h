@@ -11,9 +11,8 @@
 
 static inline bool vgic_broadcast(struct vcpu* vcpu, struct vgic_int* interrupt)
 {
-    UNUSED_ARG(vcpu);
-
-    return (interrupt->route & GICD_IROUTER_IRM_BIT);
+    bool spread = interrupt->hw && (vcpu->vm->arch.vgicd.route_policy == VGIC_ROUTE_SPREAD);
+    return (interrupt->route & GICD_IROUTER_IRM_BIT) && !spread;
 }
 
 static inline bool vgic_int_vcpu_is_target(struct vcpu* vcpu, struct vgic_int* interrupt)
@@ -21,6 +21,7 @@ struct arch_vm_platform {
         paddr_t gicc_addr;
         paddr_t gicr_addr;
         size_t interrupt_num;
+        enum vgic_route_policy route_policy;
     } gic;
 
 #ifdef MEM_PROT_MMU
@@ -61,6 +62,7 @@ struct vcpu* vm_get_vcpu_by_mpidr(struct vm* vm, unsigned long mpidr);
 void vcpu_arch_entry(void);
 
 bool vcpu_arch_profile_on(struct vcpu* vcpu);
+void vcpu_arch_profile_reset(struct vcpu* vcpu);
 void vcpu_subarch_reset(struct vcpu* vcpu);
 
 void vm_arch_profile_init(struct vm* vm);
@@ -27,6 +27,11 @@ void interrupts_arch_ipi_send(cpuid_t target_cpu)
     gic_send_sgi(target_cpu, interrupts_ipi_id);
 }
 
+void interrupts_arch_ipi_send_mask(cpumap_t cpu_targets)
+{
+    gic_send_sgi_mask(cpu_targets, interrupts_ipi_id);
+}
+
 inline irqid_t interrupts_arch_reserve(irqid_t pint_id)
 {
     return pint_id;
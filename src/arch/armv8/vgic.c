@@ -21,6 +21,7 @@
 #include <interrupts.h>
 #include <vm.h>
 #include <platform.h>
+#include <stats.h>
 
 enum VGIC_EVENTS { VGIC_UPDATE_ENABLE, VGIC_ROUTE, VGIC_INJECT, VGIC_SET_REG };
 extern volatile const size_t VGIC_IPI_ID;
@@ -137,10 +138,17 @@ void vgic_send_sgi_msg(struct vcpu* vcpu, cpumap_t pcpu_mask, irqid_t int_id)
         VGIC_MSG_DATA(cpu()->vcpu->vm->id, 0, int_id, 0, cpu()->vcpu->id),
     };
 
-    for (size_t i = 0; i < platform.cpu_num; i++) {
-        if (pcpu_mask & (1ULL << i)) {
-            cpu_send_msg(i, &msg);
-        }
+    /**
+     * A vSGI targeting the vcpu running on this cpu is injected directly instead of going through
+     * a self-addressed message and physical IPI.
+     */
+    if (pcpu_mask & ((cpumap_t)1 << cpu()->id)) {
+        vgic_inject(cpu()->vcpu, int_id, cpu()->vcpu->id);
+        pcpu_mask &= ~((cpumap_t)1 << cpu()->id);
+    }
+
+    if (pcpu_mask != 0) {
+        cpu_send_msg_multicast(pcpu_mask, &msg);
     }
 }
 
@@ -162,10 +170,8 @@ static void vgic_route(struct vcpu* vcpu, struct vgic_int* interrupt)
         };
         vgic_yield_ownership(vcpu, interrupt);
         cpumap_t trgtlist = vgic_int_ptarget_mask(vcpu, interrupt) & ~(1UL << vcpu->phys_id);
-        for (size_t i = 0; i < platform.cpu_num; i++) {
-            if (trgtlist & (1ULL << i)) {
-                cpu_send_msg(i, &msg);
-            }
+        if (trgtlist != 0) {
+            cpu_send_msg_multicast(trgtlist, &msg);
         }
     }
 }
@@ -303,6 +309,7 @@ static void vgic_spill_lr(struct vcpu* vcpu, size_t lr_ind)
     struct vgic_int* spilled_int = vgic_get_int(vcpu, (irqid_t)GICH_LR_VID(lr), vcpu->id);
 
     if (spilled_int != NULL) {
+        STATS_INC(vcpu->arch.vgic_priv.stats.lr_spills);
         spin_lock(&spilled_int->lock);
         vgic_remove_lr(vcpu, spilled_int);
         vgic_add_spilled(vcpu, spilled_int);
@@ -1099,6 +1106,7 @@ static void vgic_refill_lrs(struct vcpu* vcpu, bool npie)
             if (got_ownership) {
                 list_rm(list, &irq->node);
                 vgic_write_lr(vcpu, irq, (size_t)lr_ind);
+                STATS_INC(vcpu->arch.vgic_priv.stats.lr_refills);
             }
             spin_unlock(&irq->lock);
             if (!got_ownership) {
@@ -1146,29 +1154,39 @@ static void vgic_handle_trapped_eoir(struct vcpu* vcpu)
         gich_write_lr((size_t)lr_ind, 0);
 
         struct vgic_int* interrupt = vgic_get_int(vcpu, (irqid_t)(lr_val), vcpu->id);
-        if (interrupt == NULL) {
-            continue;
-        }
-
-        spin_lock(&interrupt->lock);
-        interrupt->in_lr = false;
-        if (interrupt->id < GIC_MAX_SGIS) {
-            vgic_add_lr(vcpu, interrupt);
-        } else {
-            vgic_yield_ownership(vcpu, interrupt);
+        if (interrupt != NULL) {
+            spin_lock(&interrupt->lock);
+            interrupt->in_lr = false;
+            if (interrupt->id < GIC_MAX_SGIS) {
+                vgic_add_lr(vcpu, interrupt);
+            } else {
+                vgic_yield_ownership(vcpu, interrupt);
+            }
+            spin_unlock(&interrupt->lock);
         }
-        spin_unlock(&interrupt->lock);
         eisr = gich_get_eisr();
         lr_ind = bit64_ffs(eisr & BIT64_MASK(0, NUM_LRS));
     }
 }
 
+static void vgic_stats_report(struct vcpu* vcpu)
+{
+    struct vgic_stats* stats = &vcpu->arch.vgic_priv.stats;
+    if (stats_report_due(stats->maint_irqs)) {
+        INFO("vgic: vm %lu vcpu %lu maint %lu spills %lu refills %lu eoi deact %lu\n",
+            vcpu->vm->id, vcpu->id, stats->maint_irqs, stats->lr_spills, stats->lr_refills,
+            stats->eoi_deactivates);
+    }
+}
+
 void gic_maintenance_handler(irqid_t irq_id)
 {
     UNUSED_ARG(irq_id);
 
     uint32_t misr = gich_get_misr();
 
+    STATS_INC(cpu()->vcpu->arch.vgic_priv.stats.maint_irqs);
+
     if (misr & GICH_MISR_EOI) {
         vgic_handle_trapped_eoir(cpu()->vcpu);
     }
@@ -1178,14 +1196,21 @@ void gic_maintenance_handler(irqid_t irq_id)
     }
 
     if (misr & GICH_MISR_LRENP) {
-        uint32_t hcr_el2 = gich_get_hcr();
-        while (hcr_el2 & GICH_HCR_EOICount_MASK) {
+        /**
+         * The guest is not running, so EOICount is stable. Deactivate every counted spilled
+         * interrupt and then reset the count with a single write, instead of a read-modify-write
+         * of the HCR per deactivation.
+         */
+        uint32_t eoi_count =
+            (gich_get_hcr() & GICH_HCR_EOICount_MASK) >> GICH_HCR_EOICount_OFF;
+        for (uint32_t i = 0; i < eoi_count; i++) {
             vgic_eoir_highest_spilled_active(cpu()->vcpu);
-            hcr_el2 -= (1U << GICH_HCR_EOICount_OFF);
-            gich_set_hcr(hcr_el2);
-            hcr_el2 = gich_get_hcr();
         }
+        STATS_ADD(cpu()->vcpu->arch.vgic_priv.stats.eoi_deactivates, eoi_count);
+        gich_set_hcr(gich_get_hcr() & ~GICH_HCR_EOICount_MASK);
     }
+
+    vgic_stats_report(cpu()->vcpu);
 }
 
 size_t vgic_get_itln(const struct vgic_dscrp* vgic_dscrp)
@@ -48,7 +48,11 @@ static bool vgic_int_set_route(struct vcpu* vcpu, struct vgic_int* interrupt, un
         return false;
     }
 
-    if (route & GICD_IROUTER_IRM_BIT) {
+    if ((route & GICD_IROUTER_IRM_BIT) && interrupt->hw &&
+        (vcpu->vm->arch.vgicd.route_policy == VGIC_ROUTE_SPREAD)) {
+        struct vcpu* tvcpu = vm_get_vcpu(vcpu->vm, interrupt->id % vcpu->vm->cpu_num);
+        phys_route = cpu_id_to_mpidr(tvcpu->phys_id) & MPIDR_AFF_MSK;
+    } else if (route & GICD_IROUTER_IRM_BIT) {
         phys_route = cpu_id_to_mpidr(vcpu->phys_id);
     } else {
         struct vcpu* tvcpu = vm_get_vcpu_by_mpidr(vcpu->vm, route & MPIDR_AFF_MSK);
@@ -328,6 +332,7 @@ void vgic_init(struct vm* vm, const struct vgic_dscrp* vgic_dscrp)
         (((vm->cpu_num - 1) << GICD_TYPER_CPUNUM_OFF) & GICD_TYPER_CPUNUM_MSK) |
         (((10 - 1) << GICD_TYPER_IDBITS_OFF) & GICD_TYPER_IDBITS_MSK));
     vm->arch.vgicd.IIDR = gicd->IIDR;
+    vm->arch.vgicd.route_policy = vgic_dscrp->route_policy;
     vm->arch.vgicd.lock = SPINLOCK_INITVAL;
 
     size_t vgic_int_size = vm->arch.vgicd.int_num * sizeof(struct vgic_int);
@@ -10,6 +10,7 @@
 #include <arch/aborts.h>
 #include <arch/emul.h>
 #include <srs.h>
+#include <stats.h>
 
 #define MDP_HOST          (0x91)
 #define MDP_GUEST         (0x99)
@@ -107,39 +108,74 @@ static unsigned long ds_to_width(unsigned long ds)
     return (1UL << ds);
 }
 
-static void decode_access(struct emul_access* acc, unsigned long addr)
+static void decode_bitop(struct emul_access* acc, struct vcpu* vcpu, unsigned long pc)
 {
-    unsigned long mei = srs_mei_read();
-
-    unsigned int reg = MEI_GET_REG(mei);
-    unsigned int ds = MEI_GET_DS(mei);
-    unsigned int u = MEI_GET_U(mei);
-    unsigned int rw = MEI_GET_RW(mei);
-
     /* Decode possible bitwise instruction */
-    unsigned long inst = read_instruction(vcpu_readpc(cpu()->vcpu));
+    unsigned long inst = read_instruction(pc);
     unsigned long opcode = ((inst & OPCODE_MASK) >> OPCODE_SHIFT);
     unsigned long subopcode = ((inst & SUBOPCODE_MASK) >> SUBOPCODE_SHIFT);
     unsigned long bwop = EMUL_ARCH_BWOP_NO;
     uint8_t bit = 0;
 
     if (opcode == F8_OPCODE) {
-        bit = (inst & BITIDX_MASK) >> BITIDX_SHIFT;
+        bit = (uint8_t)((inst & BITIDX_MASK) >> BITIDX_SHIFT);
         bwop = ((inst & SUB8_MASK) >> SUB8_SHIFT) + 1;
     } else if (opcode == F9_OPCODE && subopcode == F9_SUBOPCODE) {
         unsigned long reg_idx = (inst & REGIDX_MASK) >> REGIDX_SHIFT;
         /* only the three LSB of register val are used as bit index */
-        bit = vcpu_readreg(cpu()->vcpu, reg_idx) & 0x7;
+        bit = vcpu_readreg(vcpu, reg_idx) & 0x7;
         bwop = ((inst & SUB9_MASK) >> SUB9_SHIFT) + 1;
     }
 
+    acc->arch.bwop = (enum emul_arch_bwop)bwop;
+    acc->arch.bit = bit;
+}
+
+static void decode_stats_report(struct vcpu* vcpu)
+{
+    unsigned long hits = vcpu->arch.decode_hits;
+    unsigned long total = hits + vcpu->arch.decode_misses;
+    if ((total != 0) && stats_report_due(total)) {
+        INFO("decode cache: vm %lu vcpu %lu accesses %lu hits %lu (%lu%%)\n", vcpu->vm->id,
+            vcpu->id, total, hits, (hits * 100UL) / total);
+    }
+}
+
+static void decode_access(struct emul_access* acc, unsigned long addr, unsigned long mei)
+{
+    struct vcpu* vcpu = cpu()->vcpu;
+    unsigned long pc = vcpu_readpc(vcpu);
+
+    unsigned int reg = MEI_GET_REG(mei);
+    unsigned int ds = MEI_GET_DS(mei);
+    unsigned int u = MEI_GET_U(mei);
+    unsigned int rw = MEI_GET_RW(mei);
+
+    /* Reading the instruction requires opening and closing hypervisor access
+    to the guest space, so drivers polling a register from the same loop are
+    served from the decode cache instead. */
+    struct emul_decode_entry* entry =
+        &vcpu->arch.decode_cache[(pc >> 1) & (EMUL_DECODE_CACHE_SIZE - 1)];
+    if (entry->valid && entry->pc == pc && entry->mei == mei) {
+        STATS_INC(vcpu->arch.decode_hits);
+        acc->arch.bwop = EMUL_ARCH_BWOP_NO;
+        acc->arch.bit = 0;
+    } else {
+        STATS_INC(vcpu->arch.decode_misses);
+        decode_bitop(acc, vcpu, pc);
+        /* MEI does not carry the bit operation nor its bit index, so bit
+        operations are always decoded from the instruction itself */
+        entry->pc = pc;
+        entry->mei = mei;
+        entry->valid = (acc->arch.bwop == EMUL_ARCH_BWOP_NO);
+    }
+    decode_stats_report(vcpu);
+
     acc->addr = addr;
     acc->width = ds_to_width(ds);
     acc->write = rw ? true : false;
     acc->reg = reg;
     acc->sign_ext = ~u;
-    acc->arch.bwop = bwop;
-    acc->arch.bit = bit;
 }
 
 static void data_abort(void)
@@ -151,7 +187,7 @@ static void data_abort(void)
     emul_handler_t handler = vm_emul_get_mem(cpu()->vcpu->vm, addr);
     if (handler != NULL) {
         struct emul_access emul;
-        decode_access(&emul, addr);
+        decode_access(&emul, addr, mei);
 
         if (handler(&emul)) {
             unsigned long pc_step = MEI_GET_LEN(mei);
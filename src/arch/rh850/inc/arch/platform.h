@@ -9,6 +9,13 @@
 #include <bao.h>
 
 // Arch-specific platform data
+struct plat_device {
+    unsigned long dev_base;
+    /* PBGPROT1 registers of the P-Bus guard channels covering the device */
+    unsigned long pbg_num;
+    unsigned long* pbg_prot;
+};
+
 struct arch_platform {
     struct {
         paddr_t intc1_addr;
@@ -22,6 +29,9 @@ struct arch_platform {
     paddr_t bootctrl_addr;
 
     paddr_t ipir_addr;
+
+    unsigned long device_num;
+    const struct plat_device* devices;
 };
 
 #endif /* __ARCH_PLATFORM_H__ */
@@ -35,8 +35,29 @@ struct vm_arch {
     struct emul_mem bootctrl_emul;
 };
 
+/* Number of trapping instructions whose decoding is kept per vcpu. It must be
+a power of two. */
+#ifndef EMUL_DECODE_CACHE_SIZE
+#define EMUL_DECODE_CACHE_SIZE 8
+#endif
+
+/**
+ * A guest access that caused a data abort and is not a bit operation. Such an
+ * access is fully described by MEI, which encodes the instruction length,
+ * access size and data register, so a hit only needs to match the faulting PC
+ * and MEI.
+ */
+struct emul_decode_entry {
+    unsigned long pc;
+    unsigned long mei;
+    bool valid;
+};
+
 struct vcpu_arch {
     bool started;
+    struct emul_decode_entry decode_cache[EMUL_DECODE_CACHE_SIZE];
+    unsigned long decode_hits;
+    unsigned long decode_misses;
 };
 
 struct arch_regs {
@@ -28,6 +28,31 @@ extern volatile struct feinc* feinc_hw[PLAT_CPU_NUM];
 #define INTC_EIBD_PEID_MASK (0x7UL)
 #define INTC_EIBD_HYP_MASK  (~INTC_EIBD_PEID_MASK)
 
+/*
+ * Guests typically initialize the interrupt controller by sweeping every
+ * channel with the same value, most of which are already in the requested
+ * state. The physical register is the only shadow we can trust since the
+ * hardware updates the request flags on its own, so instead of deferring
+ * writes we compare against it and only issue the (slow) peripheral bus write
+ * when the value actually changes.
+ */
+static inline unsigned long vintc_merge(unsigned long cur, unsigned long val, unsigned long mask,
+    size_t addr_off)
+{
+    return ((val & mask) << (addr_off * 8)) | (cur & ~(mask << (addr_off * 8)));
+}
+
+static inline void vintc_bwop(struct emul_access* acc, volatile void* reg, size_t addr_off)
+{
+    volatile uint8_t* byte_addr = ((volatile uint8_t*)reg) + addr_off;
+    uint8_t cur = *byte_addr;
+    uint8_t val = emul_arch_bwop_emul_acc(&acc->arch, cur);
+
+    if (val != cur) {
+        *byte_addr = val;
+    }
+}
+
 void vintc_inject(struct vcpu* vcpu, irqid_t int_id)
 {
     if (!vm_has_interrupt(vcpu->vm, int_id)) {
@@ -57,12 +82,14 @@ static void emulate_intc_eic_access(struct emul_access* acc)
 
     if (vm_has_interrupt(vm, int_id)) {
         if (emul_arch_is_bwop(&acc->arch)) {
-            volatile uint8_t* byte_addr = ((volatile uint8_t*)tgt_reg) + addr_off;
-            *byte_addr = emul_arch_bwop_emul_acc(&acc->arch, *byte_addr);
+            vintc_bwop(acc, tgt_reg, addr_off);
         } else if (acc->write) {
             unsigned long val = vcpu_readreg(vcpu, acc->reg);
-            *tgt_reg = (uint16_t)(((val & mask) << (addr_off * 8)) |
-                (*tgt_reg & ~(mask << (addr_off * 8))));
+            uint16_t cur = *tgt_reg;
+            uint16_t new_val = (uint16_t)vintc_merge(cur, val, mask, addr_off);
+            if (new_val != cur) {
+                *tgt_reg = new_val;
+            }
         } else {
             unsigned long val = *tgt_reg;
 
@@ -89,42 +116,35 @@ static void emulate_intc_imr_access(struct emul_access* acc)
 
     unsigned long mask = BIT_MASK(0, acc->width * 8);
     size_t addr_off = acc->addr & 0x3UL;
-    irqid_t first_imr_int = 0;
     volatile uint32_t* tgt_reg = &(intc2_hw->IMR[reg_idx]);
 
-    first_imr_int = reg_idx * 32;
-    first_imr_int += 32;
+    /* Each IMR covers 32 interrupts starting at a granule boundary of the
+    VM's interrupt bitmap, so the VM ownership mask is a single word. */
+    irqid_t first_imr_int = (reg_idx + 1) * 32;
+    uint32_t owned = 0;
+    if (first_imr_int < MAX_GUEST_INTERRUPTS) {
+        owned = vm->interrupt_bitmap[first_imr_int / BITMAP_GRANULE_LEN];
+    }
 
     if (emul_arch_is_bwop(&acc->arch)) {
         volatile uint8_t* byte_addr = ((volatile uint8_t*)tgt_reg) + addr_off;
-        *byte_addr = emul_arch_bwop_emul_acc(&acc->arch, *byte_addr);
+        uint8_t owned_byte = (uint8_t)(owned >> (addr_off * 8));
+        uint8_t cur = *byte_addr;
+        uint8_t val = emul_arch_bwop_emul_acc(&acc->arch, cur & owned_byte);
+        val = (uint8_t)((val & owned_byte) | (cur & ~owned_byte));
+        if (val != cur) {
+            *byte_addr = val;
+        }
     } else if (acc->write) {
         unsigned long val = vcpu_readreg(vcpu, acc->reg);
-        unsigned long write_val = *tgt_reg;
-
-        for (unsigned int i = 0; i < 32; i++) {
-            if (!vm_has_interrupt(vm, i + first_imr_int)) {
-                continue;
-            }
-            if ((1UL << i) & val) {
-                write_val |= (1UL << i);
-            } else {
-                write_val &= ~(1UL << i);
-            }
+        unsigned long wr_mask = (mask << (addr_off * 8)) & owned;
+        uint32_t cur = *tgt_reg;
+        uint32_t new_val = (uint32_t)((cur & ~wr_mask) | ((val << (addr_off * 8)) & wr_mask));
+        if (new_val != cur) {
+            *tgt_reg = new_val;
         }
-        *tgt_reg = ((write_val & mask) << (addr_off * 8)) | (*tgt_reg & ~(mask << (addr_off * 8)));
     } else {
-        unsigned long val = 0;
-
-        for (unsigned int i = 0; i < 32; i++) {
-            if (!vm_has_interrupt(vm, i + first_imr_int)) {
-                continue;
-            }
-            unsigned int imr_val = *tgt_reg;
-            if ((1UL << i) & imr_val) {
-                val |= (1UL << i);
-            }
-        }
+        unsigned long val = *tgt_reg & owned;
 
         val = (val >> (addr_off * 8)) & mask;
         if (acc->sign_ext && (1UL << (acc->width * 8 - 1) & val)) {
@@ -151,8 +171,7 @@ static void emulate_intc_eibd_access(struct emul_access* acc)
 
     if (vm_has_interrupt(vm, int_id)) {
         if (emul_arch_is_bwop(&acc->arch)) {
-            volatile uint8_t* byte_addr = ((volatile uint8_t*)tgt_reg) + addr_off;
-            *byte_addr = emul_arch_bwop_emul_acc(&acc->arch, *byte_addr);
+            vintc_bwop(acc, tgt_reg, addr_off);
         } else if (acc->write) {
             unsigned long val = vcpu_readreg(vcpu, acc->reg);
             unsigned long virt_peid = val & 0x7UL;
@@ -161,8 +180,12 @@ static void emulate_intc_eibd_access(struct emul_access* acc)
                 /* in case the vcpu_id is invalid sanitize the write by using the first vcpu */
                 phys_peid = vm_translate_to_pcpuid(vm, 0);
             }
-            val = (*tgt_reg & INTC_EIBD_HYP_MASK) | (phys_peid & INTC_EIBD_PEID_MASK);
-            *tgt_reg = ((val & mask) << (addr_off * 8)) | (*tgt_reg & ~(mask << (addr_off * 8)));
+            uint32_t cur = *tgt_reg;
+            val = (cur & INTC_EIBD_HYP_MASK) | (phys_peid & INTC_EIBD_PEID_MASK);
+            uint32_t new_val = (uint32_t)vintc_merge(cur, val, mask, addr_off);
+            if (new_val != cur) {
+                *tgt_reg = new_val;
+            }
         } else {
             unsigned long val = *tgt_reg;
             unsigned long phys_peid = val & 0x7UL;
@@ -201,11 +224,14 @@ static void emulate_intc_eeic_access(struct emul_access* acc)
 
     if (vm_has_interrupt(vm, int_id)) {
         if (emul_arch_is_bwop(&acc->arch)) {
-            volatile uint8_t* byte_addr = ((volatile uint8_t*)tgt_reg) + addr_off;
-            *byte_addr = emul_arch_bwop_emul_acc(&acc->arch, *byte_addr);
+            vintc_bwop(acc, tgt_reg, addr_off);
         } else if (acc->write) {
             unsigned long val = vcpu_readreg(vcpu, acc->reg);
-            *tgt_reg = ((val & mask) << (addr_off * 8)) | (*tgt_reg & ~(mask << (addr_off * 8)));
+            uint32_t cur = *tgt_reg;
+            uint32_t new_val = (uint32_t)vintc_merge(cur, val, mask, addr_off);
+            if (new_val != cur) {
+                *tgt_reg = new_val;
+            }
         } else {
             unsigned long val = *tgt_reg;
 
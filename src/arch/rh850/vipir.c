@@ -47,9 +47,8 @@ static bool vipir_emul_handler(struct emul_access* acc)
         pe_idx = vm_translate_to_pcpuid(vm, virt_peid);
     }
 
-    spin_lock(&ipir_lock[pe_idx][chan_idx]);
-
-    switch (acc_offset & IPIR_REG_OFFSET_MASK) {
+    size_t reg_off = acc_offset & IPIR_REG_OFFSET_MASK;
+    switch (reg_off) {
         case offsetof(struct ipir_chann, IPInEN):
             tgt_reg = &(ipir->pe[pe_idx].chann[chan_idx].IPInEN);
             break;
@@ -69,23 +68,63 @@ static bool vipir_emul_handler(struct emul_access* acc)
             tgt_reg = NULL;
     }
 
-    if ((chan_idx != IPI_HYP_IRQ_ID) && (tgt_reg != NULL)) {
-        if (emul_arch_is_bwop(&acc->arch)) {
-            acc->arch.bit = (uint8_t)vm_translate_to_pcpuid(vm, acc->arch.bit);
+    if ((chan_idx == IPI_HYP_IRQ_ID) || (tgt_reg == NULL)) {
+        return true;
+    }
+
+    if (emul_arch_is_bwop(&acc->arch)) {
+        /* The bit index names a vcpu, bit operations on vcpus the VM doesn't have are ignored */
+        cpuid_t pbit = vm_translate_to_pcpuid(vm, acc->arch.bit);
+        if (pbit == INVALID_CPUID) {
+            return true;
+        }
+        acc->arch.bit = (uint8_t)pbit;
+        if (reg_off == offsetof(struct ipir_chann, IPInEN)) {
+            spin_lock(&ipir_lock[pe_idx][chan_idx]);
             *tgt_reg = emul_arch_bwop_emul_acc(&acc->arch, *tgt_reg);
-        } else if (acc->write) {
-            unsigned long val = (uint8_t)vcpu_readreg(vcpu, acc->reg);
-            val = (uint8_t)vm_translate_to_pcpu_mask(vm, val, PLAT_CPU_NUM);
-            *tgt_reg = (uint8_t)((*tgt_reg & ~vm->cpus) | (val & vm->cpus));
+            spin_unlock(&ipir_lock[pe_idx][chan_idx]);
         } else {
-            uint8_t val = *tgt_reg;
-            val = (uint8_t)vm_translate_to_vcpu_mask(vm, val, PLAT_CPU_NUM);
-            vcpu_writereg(vcpu, acc->reg, val);
+            /* The other registers are write-one. Writing back the whole byte
+            would re-request or clear the other cpus' bits, so only write the
+            accessed bit, and only if the operation leaves it set. */
+            uint8_t bitmask = (uint8_t)((1UL << acc->arch.bit) & vm->cpus);
+            uint8_t cur = *tgt_reg;
+            uint8_t val = emul_arch_bwop_emul_acc(&acc->arch, cur);
+            if (reg_off == offsetof(struct ipir_chann, IPInREQ)) {
+                val &= (uint8_t)~cur;
+            }
+            if ((reg_off != offsetof(struct ipir_chann, IPInFLG)) && ((val & bitmask) != 0)) {
+                *tgt_reg = bitmask;
+            }
         }
+    } else if (acc->write) {
+        unsigned long val = (uint8_t)vcpu_readreg(vcpu, acc->reg);
+        val = (uint8_t)vm_translate_to_pcpu_mask(vm, val, PLAT_CPU_NUM) & vm->cpus;
+
+        if (reg_off == offsetof(struct ipir_chann, IPInEN)) {
+            /* The enable mask is the only register that needs a read-modify-write
+            to preserve the bits of other VMs' cpus. */
+            spin_lock(&ipir_lock[pe_idx][chan_idx]);
+            *tgt_reg = (uint8_t)((*tgt_reg & ~vm->cpus) | val);
+            spin_unlock(&ipir_lock[pe_idx][chan_idx]);
+        } else if (reg_off == offsetof(struct ipir_chann, IPInREQ)) {
+            /* Request bits are write-one-to-set and all targets are raised by a
+            single write. Targets with a request still pending would not see a
+            second one, so skip the write if nothing new is requested. */
+            val &= ~(unsigned long)*tgt_reg;
+            if (val != 0) {
+                *tgt_reg = (uint8_t)val;
+            }
+        } else {
+            /* The clear registers are write-one-to-clear, zeros are ignored */
+            *tgt_reg = (uint8_t)val;
+        }
+    } else {
+        uint8_t val = *tgt_reg;
+        val = (uint8_t)vm_translate_to_vcpu_mask(vm, val, PLAT_CPU_NUM);
+        vcpu_writereg(vcpu, acc->reg, val);
     }
 
-    spin_unlock(&ipir_lock[pe_idx][chan_idx]);
-
     return true;
 }
 
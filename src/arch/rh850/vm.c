@@ -10,6 +10,7 @@
 #include <platform.h>
 #include <vipir.h>
 #include <vbootctrl.h>
+#include <plat/pbg.h>
 
 void vm_arch_init(struct vm* vm, const struct vm_config* vm_config)
 {
@@ -40,6 +41,9 @@ void vcpu_arch_reset(struct vcpu* vcpu, vaddr_t entry)
 
     vcpu->arch.started = vcpu->id == 0 ? true : false;
 
+    /* the guest image may have been reloaded, drop any decoded instruction */
+    memset(vcpu->arch.decode_cache, 0, sizeof(vcpu->arch.decode_cache));
+
     /* Bao fixes the VMID as SPID to isolate VM memory regions */
     srs_gmspid_write(vm->id);
     srs_gmspidlist_write(0x0);
@@ -101,3 +105,11 @@ void vcpu_writepc(struct vcpu* vcpu, unsigned long val)
 {
     vcpu->regs.pc = val;
 }
+
+void vm_arch_allow_mmio_access(struct vm* vm, struct vm_dev_region* dev)
+{
+    /* VM accesses are tagged with the VM id as SPID (see vcpu_arch_reset) */
+    if (!pbg_allow_device(dev->pa, vm->id)) {
+        ERROR("Device 0x%lx has no P-Bus guard channels described\n", (unsigned long)dev->pa);
+    }
+}
@@ -26,6 +26,9 @@
 /* Sstc Extension */
 #define CSR_VSTIMECMP     0x24D
 #define CSR_VSTIMECMPH    0x25D
+/* Unprivileged Counters */
+#define CSR_TIME          0xC01
+#define CSR_TIMEH         0xC81
 /* Supervisor State Enable (Ssstateen Extension)*/
 #define CSR_SSTATEEN0     0x10C
 #define CSR_SSTATEEN1     0x10D
@@ -365,6 +368,7 @@ CSRS_GEN_ACCESSORS_NAMED(stopei, CSR_STOPEI)
 CSRS_GEN_ACCESSORS_NAMED(stopi, CSR_STOPI)
 
 #if defined(RV64)
+CSRS_GEN_ACCESSORS_NAMED(time, CSR_TIME)
 CSRS_GEN_ACCESSORS_NAMED(stimecmp, CSR_STIMECMP)
 CSRS_GEN_ACCESSORS_NAMED(vstimecmp, CSR_VSTIMECMP)
 CSRS_GEN_ACCESSORS_NAMED(henvcfg, CSR_HENVCFG)
@@ -395,6 +399,20 @@ CSRS_GEN_ACCESSORS_NAMED(htimedeltal, CSR_HTIMEDELTA)
 CSRS_GEN_ACCESSORS_NAMED(htimedeltah, CSR_HTIMEDELTAH)
 CSRS_GEN_ACCESSORS_MERGED(htimedelta, htimedeltal, htimedeltah)
 
+CSRS_GEN_ACCESSORS_NAMED(timel, CSR_TIME)
+CSRS_GEN_ACCESSORS_NAMED(timeh, CSR_TIMEH)
+
+static inline unsigned long long csrs_time_read(void)
+{
+    unsigned long timeh;
+    unsigned long timel;
+    do {
+        timeh = csrs_timeh_read();
+        timel = csrs_timel_read();
+    } while (timeh != csrs_timeh_read());
+    return ((unsigned long long)timeh << 32) | timel;
+}
+
 CSRS_GEN_ACCESSORS_NAMED(stimecmpl, CSR_STIMECMP)
 CSRS_GEN_ACCESSORS_NAMED(stimecmph, CSR_STIMECMPH)
 CSRS_GEN_ACCESSORS_MERGED(stimecmp, stimecmpl, stimecmph)
@@ -14,4 +14,54 @@ static inline uint64_t hlvxhu(uintptr_t addr)
     return value;
 }
 
+static inline void fence_i(void)
+{
+    __asm__ volatile(".insn i 0x0f, 0x1, x0, x0, 0\n\t" ::: "memory");
+}
+
+static inline void hfence_vvma_all(void)
+{
+    __asm__ volatile(".insn r 0x73, 0x0, 0x11, x0, x0, x0\n\t" ::: "memory");
+}
+
+static inline void hfence_vvma_va(unsigned long va)
+{
+    __asm__ volatile(".insn r 0x73, 0x0, 0x11, x0, %0, x0\n\t" ::"r"(va) : "memory");
+}
+
+static inline void hfence_vvma_asid(unsigned long asid)
+{
+    __asm__ volatile(".insn r 0x73, 0x0, 0x11, x0, x0, %0\n\t" ::"r"(asid) : "memory");
+}
+
+static inline void hfence_vvma_va_asid(unsigned long va, unsigned long asid)
+{
+    __asm__ volatile(".insn r 0x73, 0x0, 0x11, x0, %0, %1\n\t" ::"r"(va), "r"(asid) : "memory");
+}
+
+/**
+ * Svinval extension instructions. hinval.vvma invalidations must be bracketed by sfence.w.inval
+ * and sfence.inval.ir to be ordered with respect to previous stores and subsequent accesses.
+ */
+
+static inline void sfence_w_inval(void)
+{
+    __asm__ volatile(".insn r 0x73, 0x0, 0x0c, x0, x0, x0\n\t" ::: "memory");
+}
+
+static inline void sfence_inval_ir(void)
+{
+    __asm__ volatile(".insn r 0x73, 0x0, 0x0c, x0, x0, x1\n\t" ::: "memory");
+}
+
+static inline void hinval_vvma_va(unsigned long va)
+{
+    __asm__ volatile(".insn r 0x73, 0x0, 0x13, x0, %0, x0\n\t" ::"r"(va) : "memory");
+}
+
+static inline void hinval_vvma_va_asid(unsigned long va, unsigned long asid)
+{
+    __asm__ volatile(".insn r 0x73, 0x0, 0x13, x0, %0, %1\n\t" ::"r"(va), "r"(asid) : "memory");
+}
+
 #endif /* ARCH_INSTRUCTIONS_H */
@@ -39,6 +39,24 @@ struct sbi_hsm {
     unsigned long priv;
 };
 
+struct sbi_rfence_req {
+    bool fence_i;
+    bool vma;
+    bool all_asid;
+    unsigned long start_addr;
+    unsigned long size;
+    unsigned long asid;
+};
+
+/* Remote fence requests pending on a vcpu. Requests posted while one is pending are merged. */
+struct sbi_rfence {
+    spinlock_t lock;
+    bool pending;
+    struct sbi_rfence_req req;
+    size_t req_seq;
+    volatile size_t done_seq;
+};
+
 void sbi_init(void);
 size_t sbi_vs_handler(void);
 
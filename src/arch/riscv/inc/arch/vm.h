@@ -71,6 +71,7 @@ struct vm_arch {
 struct vcpu_arch {
     vcpuid_t hart_id;
     struct sbi_hsm sbi_ctx;
+    struct sbi_rfence rfence;
 };
 
 struct arch_regs {
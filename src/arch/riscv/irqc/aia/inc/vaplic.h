@@ -22,6 +22,10 @@ struct vaplic {
     uint32_t ip[APLIC_MAX_INTERRUPTS / 32];
     uint32_t ie[APLIC_MAX_INTERRUPTS / 32];
     uint32_t target[APLIC_MAX_INTERRUPTS];
+    /* Per-hart bitmap of the pending and enabled sources targeting that hart */
+    uint32_t pend_enbl[APLIC_DOMAIN_NUM_HARTS][APLIC_MAX_INTERRUPTS / 32];
+    /* Serializes the topi evaluation of each hart, independently of the domain lock */
+    spinlock_t hart_lock[APLIC_DOMAIN_NUM_HARTS];
     BITMAP_ALLOC(idelivery, APLIC_DOMAIN_NUM_HARTS);
     BITMAP_ALLOC(iforce, APLIC_DOMAIN_NUM_HARTS);
     uint32_t ithreshold[APLIC_DOMAIN_NUM_HARTS];
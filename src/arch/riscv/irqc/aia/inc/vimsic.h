@@ -17,6 +17,10 @@
  *        The vimsic_init function needs to be executed by every VM's virtual CPU. Then, it will
  *        calculate the physical IMSIC address based on the physical CPU into which the VCPU is
  *        mapped. Finally, it adds a new entry in the MMU.
+ *        Since all VCPUs share the VM's address space, the guest IMSIC window exposes the VS
+ *        interrupt file of every VCPU, at the page given by its VCPU id. A guest can therefore
+ *        deliver IPIs to sibling VCPUs by writing their seteipnum register directly, without
+ *        trapping to the hypervisor. The SBI IPI extension remains available as a fallback.
  *
  * @param vm Virtual Machine
  * @param vm_irqc_dscrp Virtual Machine Description
@@ -151,6 +151,67 @@ static bool vaplic_set_pend(struct vcpu* vcpu, irqid_t intp_id)
     return ret;
 }
 
+/**
+ * @brief Recomputes the bit of a given interrupt in the pending and enabled bitmap of its target
+ *        hart
+ *
+ * @pre This function should only be called by a function that has taken the lock.
+ *
+ * @param vaplic virtual aplic
+ * @param intp_id interrupt id
+ */
+static void vaplic_update_pend_enbl(struct vaplic* vaplic, irqid_t intp_id)
+{
+    vcpuid_t hart_index =
+        (vaplic->target[intp_id] >> APLIC_TARGET_HART_IDX_SHIFT) & APLIC_TARGET_HART_IDX_MASK;
+
+    if (hart_index < APLIC_DOMAIN_NUM_HARTS) {
+        if (GET_INTP_REG(vaplic->ip, intp_id) && GET_INTP_REG(vaplic->ie, intp_id)) {
+            SET_INTP_REG(vaplic->pend_enbl[hart_index], intp_id);
+        } else {
+            CLR_INTP_REG(vaplic->pend_enbl[hart_index], intp_id);
+        }
+    }
+}
+
+/**
+ * @brief Removes a given interrupt from the pending and enabled bitmap of its target hart. Must be
+ *        called before the interrupt target hart is changed.
+ *
+ * @pre This function should only be called by a function that has taken the lock.
+ *
+ * @param vaplic virtual aplic
+ * @param intp_id interrupt id
+ */
+static void vaplic_clear_pend_enbl(struct vaplic* vaplic, irqid_t intp_id)
+{
+    vcpuid_t hart_index =
+        (vaplic->target[intp_id] >> APLIC_TARGET_HART_IDX_SHIFT) & APLIC_TARGET_HART_IDX_MASK;
+
+    if (hart_index < APLIC_DOMAIN_NUM_HARTS) {
+        CLR_INTP_REG(vaplic->pend_enbl[hart_index], intp_id);
+    }
+}
+
+/**
+ * @brief Recomputes the pending and enabled bits for the interrupts [32*reg:(32*reg)+31] set in
+ *        a given mask
+ *
+ * @pre This function should only be called by a function that has taken the lock.
+ *
+ * @param vaplic virtual aplic
+ * @param reg register index
+ * @param mask interrupts to update per bit
+ */
+static void vaplic_update_pend_enbl_reg(struct vaplic* vaplic, size_t reg, uint32_t mask)
+{
+    while (mask != 0) {
+        size_t bit = (size_t)bit32_ffs(mask);
+        mask = bit32_clear(mask, bit);
+        vaplic_update_pend_enbl(vaplic, (irqid_t)((reg * APLIC_NUM_INTP_PER_REG) + bit));
+    }
+}
+
 #if (IRQC == APLIC)
 
 static uint32_t vaplic_get_idelivery(struct vcpu* vcpu, idcid_t idc_id);
@@ -172,11 +233,15 @@ static inline cpuid_t vaplic_vcpuid_to_pcpuid(struct vcpu* vcpu, vcpuid_t vhart)
 /**
  * @brief Updates the topi register with with the highest pend & en interrupt id
  *
+ * Only the sources in the hart's pending and enabled bitmap are considered, so the cost of the
+ * evaluation depends on the number of pending interrupts and not on the number of sources.
+ *
  * @param vcpu virtual cpu
+ * @param vhart_index virtual hart whose topi is updated
  * @return true if topi was updated, requiring the handling of the interrupt
  * @return false if there is no new interrupt to handle
  */
-static bool vaplic_update_topi(struct vcpu* vcpu)
+static bool vaplic_update_topi(struct vcpu* vcpu, vcpuid_t vhart_index)
 {
     struct vaplic* vaplic = &vcpu->vm->arch.vaplic;
     bool ret = false;
@@ -189,24 +254,28 @@ static bool vaplic_update_topi(struct vcpu* vcpu)
     bool idc_force = false;
     uint32_t update_topi = 0;
 
+    spin_lock(&vaplic->hart_lock[vhart_index]);
+
     /** Find highest pending and enabled interrupt */
-    for (irqid_t i = 1; i < APLIC_MAX_INTERRUPTS; i++) {
-        if (vaplic_get_hart_index(vcpu, i) == vcpu->id) {
-            if (vaplic_get_pend(vcpu, i) && vaplic_get_enbl(vcpu, i)) {
-                prio = vaplic_get_target(vcpu, i) & APLIC_TARGET_IPRIO_MASK;
-                if (prio < intp_prio) {
-                    intp_prio = prio;
-                    intp_id = i;
-                }
+    for (size_t reg = 0; reg < APLIC_NUM_SETIx_REGS; reg++) {
+        uint32_t pend_enbl = vaplic->pend_enbl[vhart_index][reg];
+        while (pend_enbl != 0) {
+            size_t bit = (size_t)bit32_ffs(pend_enbl);
+            irqid_t i = (irqid_t)((reg * APLIC_NUM_INTP_PER_REG) + bit);
+            pend_enbl = bit32_clear(pend_enbl, bit);
+            prio = vaplic->target[i] & APLIC_TARGET_IPRIO_MASK;
+            if (prio < intp_prio) {
+                intp_prio = prio;
+                intp_id = i;
             }
         }
     }
 
     /** Can interrupt be delivered? */
-    idc_threshold = vaplic_get_ithreshold(vcpu, vcpu->id);
+    idc_threshold = vaplic_get_ithreshold(vcpu, vhart_index);
     domain_enbl = !!(vaplic_get_domaincfg(vcpu) & APLIC_DOMAINCFG_IE);
-    idc_enbl = !!(vaplic_get_idelivery(vcpu, vcpu->id));
-    idc_force = !!(vaplic_get_iforce(vcpu, vcpu->id));
+    idc_enbl = !!(vaplic_get_idelivery(vcpu, vhart_index));
+    idc_force = !!(vaplic_get_iforce(vcpu, vhart_index));
 
     if ((intp_id != APLIC_MAX_INTERRUPTS) && (intp_prio < idc_threshold || idc_threshold == 0) &&
         idc_enbl && domain_enbl) {
@@ -215,7 +284,10 @@ static bool vaplic_update_topi(struct vcpu* vcpu)
     } else if (idc_force && idc_enbl && domain_enbl) {
         ret = true;
     }
-    vaplic->topi_claimi[vcpu->id] = update_topi;
+    vaplic->topi_claimi[vhart_index] = update_topi;
+
+    spin_unlock(&vaplic->hart_lock[vhart_index]);
+
     return ret;
 }
 
@@ -238,7 +310,7 @@ static void vaplic_update_hart_line(struct vcpu* vcpu, vcpuid_t vhart_index)
      *  to the targeting cpu
      */
     if (pcpu_id == cpu()->id) {
-        if (vaplic_update_topi(vcpu)) {
+        if (vaplic_update_topi(vcpu, vhart_index)) {
             csrs_hvip_set(HIP_VSEIP);
         } else {
             csrs_hvip_clear(HIP_VSEIP);
@@ -413,8 +485,12 @@ static uint32_t vaplic_get_claimi(struct vcpu* vcpu, idcid_t idc_id)
     struct vaplic* vaplic = &vcpu->vm->arch.vaplic;
     spin_lock(&vaplic->lock);
     if (idc_id < vaplic->idc_num) {
+        spin_lock(&vaplic->hart_lock[idc_id]);
         ret = vaplic->topi_claimi[idc_id];
-        CLR_INTP_REG(vaplic->ip, (ret >> IDC_CLAIMI_INTP_ID_SHIFT));
+        spin_unlock(&vaplic->hart_lock[idc_id]);
+        irqid_t intp_id = ret >> IDC_CLAIMI_INTP_ID_SHIFT;
+        CLR_INTP_REG(vaplic->ip, intp_id);
+        vaplic_update_pend_enbl(vaplic, intp_id);
         /** Spurious intp*/
         if (ret == 0) {
             bitmap_clear(vaplic->iforce, idc_id);
@@ -599,6 +675,36 @@ static void vaplic_forward_by_msi(struct vcpu* vcpu, irqid_t irq_id)
         imsic_send_guest_msi(target_vcpu->phys_id, eeid);
 
         CLR_INTP_REG(vcpu->vm->arch.vaplic.ip, irq_id);
+        vaplic_update_pend_enbl(&vcpu->vm->arch.vaplic, irq_id);
+    }
+}
+
+/**
+ * @brief Forwards all pending and enabled interrupts targeting a given hart
+ *
+ * Only the sources set in the hart's pending and enabled bitmap are visited, and the target
+ * vcpu is resolved once for the whole batch.
+ *
+ * @pre This function should only be called by a function that has taken the lock.
+ *
+ * @param vcpu virtual cpu
+ * @param hart_index target virtual hart
+ */
+static void vaplic_forward_hart_by_msi(struct vcpu* vcpu, vcpuid_t hart_index)
+{
+    struct vaplic* vaplic = &vcpu->vm->arch.vaplic;
+    struct vcpu* target_vcpu = vm_get_vcpu(vcpu->vm, hart_index);
+
+    for (size_t reg = 0; reg < APLIC_NUM_SETIx_REGS; reg++) {
+        uint32_t pend_enbl = vaplic->pend_enbl[hart_index][reg];
+        while (pend_enbl != 0) {
+            size_t bit = (size_t)bit32_ffs(pend_enbl);
+            irqid_t irq_id = (irqid_t)((reg * APLIC_NUM_INTP_PER_REG) + bit);
+            pend_enbl = bit32_clear(pend_enbl, bit);
+            imsic_send_guest_msi(target_vcpu->phys_id, vaplic_get_eeid(vcpu, irq_id));
+            CLR_INTP_REG(vaplic->ip, irq_id);
+            CLR_INTP_REG(vaplic->pend_enbl[hart_index], irq_id);
+        }
     }
 }
 
@@ -617,8 +723,9 @@ static void vaplic_update_hart(struct vcpu* vcpu, size_t vhart_index, irqid_t ir
 
     if (domain_enbl) {
         if (irq_id == INVALID_IRQID) {
-            for (irqid_t i = 1; i < APLIC_MAX_INTERRUPTS; i++) {
-                vaplic_forward_by_msi(vcpu, i);
+            struct vaplic* vaplic = &vcpu->vm->arch.vaplic;
+            for (size_t i = 0; i < vaplic->idc_num; i++) {
+                vaplic_forward_hart_by_msi(vcpu, (vcpuid_t)i);
             }
         } else {
             vaplic_forward_by_msi(vcpu, irq_id);
@@ -712,6 +819,7 @@ static void vaplic_set_sourcecfg(struct vcpu* vcpu, irqid_t intp_id, uint32_t ne
         if (new_val == APLIC_SOURCECFG_SM_INACTIVE) {
             CLR_INTP_REG(vaplic->active, intp_id);
             /** Zero pend, en and target registers if intp is now inactive */
+            vaplic_clear_pend_enbl(vaplic, intp_id);
             CLR_INTP_REG(vaplic->ip, intp_id);
             CLR_INTP_REG(vaplic->ie, intp_id);
             vaplic->target[intp_id] = 0;
@@ -759,6 +867,7 @@ static void vaplic_set_setip(struct vcpu* vcpu, size_t reg, uint32_t new_val)
         new_val &= vaplic->active[reg];
         update_intps = (~vaplic->ip[reg]) & new_val;
         vaplic->ip[reg] |= new_val;
+        vaplic_update_pend_enbl_reg(vaplic, reg, update_intps);
         for (size_t i = (reg * APLIC_NUM_INTP_PER_REG);
              i < (reg * APLIC_NUM_INTP_PER_REG) + APLIC_NUM_INTP_PER_REG; i++) {
             if (!!bit32_get(update_intps, i % 32)) {
@@ -782,6 +891,7 @@ static void vaplic_set_setipnum(struct vcpu* vcpu, uint32_t new_val)
 
     spin_lock(&vaplic->lock);
     if (vaplic_set_pend(vcpu, new_val)) {
+        vaplic_update_pend_enbl(vaplic, new_val);
         vaplic_update_hart(vcpu, vaplic_get_hart_index(vcpu, new_val), new_val);
     }
     spin_unlock(&vaplic->lock);
@@ -807,6 +917,7 @@ static void vaplic_set_in_clrip(struct vcpu* vcpu, size_t reg, uint32_t new_val)
         new_val &= vaplic->hw[reg];
         aplic_clr_pend_reg(reg, new_val);
         vaplic->ip[reg] |= aplic_get_pend_reg(reg);
+        vaplic_update_pend_enbl_reg(vaplic, reg, update_intps ^ vaplic->ip[reg]);
         update_intps &= ~(vaplic->ip[reg]);
         for (size_t i = (reg * APLIC_NUM_INTP_PER_REG);
              i < (reg * APLIC_NUM_INTP_PER_REG) + APLIC_NUM_INTP_PER_REG; i++) {
@@ -855,6 +966,7 @@ static void vaplic_set_clripnum(struct vcpu* vcpu, uint32_t new_val)
         } else {
             CLR_INTP_REG(vaplic->ip, new_val);
         }
+        vaplic_update_pend_enbl(vaplic, new_val);
         vaplic_update_hart(vcpu, vaplic_get_hart_index(vcpu, new_val), new_val);
     }
     spin_unlock(&vaplic->lock);
@@ -895,6 +1007,7 @@ static void vaplic_set_setie(struct vcpu* vcpu, size_t reg, uint32_t new_val)
         new_val &= vaplic->active[reg];
         update_intps = ~(vaplic->ie[reg]) & new_val;
         vaplic->ie[reg] |= new_val;
+        vaplic_update_pend_enbl_reg(vaplic, reg, update_intps);
         new_val &= vaplic->hw[reg];
         aplic_set_enbl_reg(reg, new_val);
         for (size_t i = (reg * APLIC_NUM_INTP_PER_REG);
@@ -924,6 +1037,7 @@ static void vaplic_set_setienum(struct vcpu* vcpu, uint32_t new_val)
             aplic_set_enbl(new_val);
         }
         SET_INTP_REG(vaplic->ie, new_val);
+        vaplic_update_pend_enbl(vaplic, new_val);
         vaplic_update_hart(vcpu, vaplic_get_hart_index(vcpu, new_val), new_val);
     }
     spin_unlock(&vaplic->lock);
@@ -946,6 +1060,7 @@ static void vaplic_set_clrie(struct vcpu* vcpu, size_t reg, uint32_t new_val)
         new_val &= vaplic->active[reg];
         update_intps = vaplic->ip[reg] & ~new_val;
         vaplic->ie[reg] &= ~(new_val);
+        vaplic_update_pend_enbl_reg(vaplic, reg, new_val);
         new_val &= vaplic->hw[reg];
         aplic_clr_enbl_reg(reg, new_val);
         for (size_t i = (reg * APLIC_NUM_INTP_PER_REG);
@@ -975,6 +1090,7 @@ static void vaplic_set_clrienum(struct vcpu* vcpu, uint32_t new_val)
             aplic_clr_enbl(new_val);
         }
         CLR_INTP_REG(vaplic->ie, new_val);
+        vaplic_update_pend_enbl(vaplic, new_val);
         vaplic_update_hart(vcpu, vaplic_get_hart_index(vcpu, new_val), new_val);
     }
     spin_unlock(&vaplic->lock);
@@ -1028,6 +1144,8 @@ static void vaplic_set_target(struct vcpu* vcpu, irqid_t intp_id, uint32_t new_v
             }
         }
 
+        vaplic_clear_pend_enbl(vaplic, intp_id);
+
         if (IRQC == AIA) {
             uint8_t guest_index =
                 (new_val >> APLIC_TARGET_GUEST_IDX_SHIFT) & APLIC_TARGET_GUEST_INDEX_MASK;
@@ -1038,6 +1156,8 @@ static void vaplic_set_target(struct vcpu* vcpu, irqid_t intp_id, uint32_t new_v
                 (uint32_t)(hart_index << APLIC_TARGET_HART_IDX_SHIFT) | priority;
         }
 
+        vaplic_update_pend_enbl(vaplic, intp_id);
+
         if (prev_hart_index != hart_index) {
             vaplic_update_hart(vcpu, prev_hart_index, intp_id);
         }
@@ -1246,13 +1366,29 @@ static void vaplic_emul_target_access(struct emul_access* acc)
 void vaplic_inject(struct vcpu* vcpu, irqid_t intp_id)
 {
     struct vaplic* vaplic = &vcpu->vm->arch.vaplic;
+    bool injected = false;
+    vcpuid_t hart_index = 0;
 
     spin_lock(&vaplic->lock);
-    /** If the intp was successfully injected, update the heart line. */
-    if (vaplic_set_pend(vcpu, intp_id)) {
-        vaplic_update_hart(vcpu, vaplic_get_hart_index(vcpu, intp_id), intp_id);
+    injected = vaplic_set_pend(vcpu, intp_id);
+    if (injected) {
+        vaplic_update_pend_enbl(vaplic, intp_id);
+        hart_index = vaplic_get_hart_index(vcpu, intp_id);
+        /** In MSI mode, forwarding consumes the pending bit so it must be done under the lock. */
+        if (IRQC == AIA) {
+            vaplic_update_hart(vcpu, hart_index, intp_id);
+        }
     }
     spin_unlock(&vaplic->lock);
+
+    /**
+     * In direct mode, if the intp was successfully injected, update the hart line. The topi
+     * evaluation is serialized by the target hart lock alone, so injections targeting different
+     * harts do not contend beyond the pending bit update.
+     */
+    if (injected && IRQC != AIA) {
+        vaplic_update_hart(vcpu, hart_index, intp_id);
+    }
 }
 
 /**
@@ -1378,6 +1514,9 @@ void vaplic_init(struct vm* vm, const union vm_irqc_dscrp* vm_irqc_dscrp)
         /* 1 IDC per hart */
         vm->arch.vaplic.idc_num = vm->cpu_num;
         vm->arch.vaplic.lock = SPINLOCK_INITVAL;
+        for (size_t i = 0; i < APLIC_DOMAIN_NUM_HARTS; i++) {
+            vm->arch.vaplic.hart_lock[i] = SPINLOCK_INITVAL;
+        }
 
         vm->arch.vaplic.aplic_domain_emul =
             (struct emul_mem){ .va_base = vm_irqc_dscrp->aia.aplic.base,
@@ -42,16 +42,6 @@ static bool vplic_get_pend(struct vcpu* vcpu, irqid_t id)
     return ret;
 }
 
-static bool vplic_get_act(struct vcpu* vcpu, irqid_t id)
-{
-    bool ret = false;
-    struct vplic* vplic = &vcpu->vm->arch.vplic;
-    if (id < PLIC_MAX_INTERRUPTS) {
-        ret = bitmap_get(vplic->act, id);
-    }
-    return ret;
-}
-
 static bool vplic_get_enbl(struct vcpu* vcpu, size_t vcntxt, irqid_t id)
 {
     bool ret = false;
@@ -97,16 +87,21 @@ static uint32_t vplic_get_threshold(struct vcpu* vcpu, size_t vcntxt)
 
 static irqid_t vplic_next_pending(struct vcpu* vcpu, size_t vcntxt)
 {
+    struct vplic* vplic = &vcpu->vm->arch.vplic;
     uint32_t max_prio = 0;
     irqid_t int_id = 0;
 
-    for (irqid_t i = 0; i < PLIC_MAX_INTERRUPTS; i++) {
-        if (vplic_get_pend(vcpu, i) && !vplic_get_act(vcpu, i) && vplic_get_enbl(vcpu, vcntxt, i)) {
-            uint32_t prio = vplic_get_prio(vcpu, i);
+    for (size_t i = 0; i < BITMAP_SIZE_IN_GRANULE(PLIC_MAX_INTERRUPTS); i++) {
+        bitmap_granule_t cand = vplic->pend[i] & ~vplic->act[i] & vplic->enbl[vcntxt][i];
+        while (cand != 0) {
+            size_t bit = (size_t)bit32_ffs(cand);
+            irqid_t id = (irqid_t)((i * BITMAP_GRANULE_LEN) + bit);
+            uint32_t prio = vplic_get_prio(vcpu, id);
             if (prio > max_prio) {
                 max_prio = prio;
-                int_id = i;
+                int_id = id;
             }
+            cand = bit32_clear(cand, bit);
         }
     }
 
@@ -238,9 +233,18 @@ void vplic_inject(struct vcpu* vcpu, irqid_t id)
         bitmap_set(vplic->pend, id);
 
         if (vplic_get_hw(vcpu, id)) {
-            struct plic_cntxt vcntxt = { vcpu->id, PRIV_S };
-            ssize_t vcntxt_id = plic_plat_cntxt_to_id(vcntxt);
-            vplic_update_hart_line(vcpu, (size_t)vcntxt_id);
+            if (vcpu == cpu()->vcpu) {
+                /**
+                 * The physical PLIC only delivers a hw interrupt to this hart if it is enabled
+                 * and above threshold on its S context, which mirrors the vcpu's virtual
+                 * context. The line must be raised, so skip the highest pending rescan.
+                 */
+                csrs_hvip_set(HIP_VSEIP);
+            } else {
+                struct plic_cntxt vcntxt = { vcpu->id, PRIV_S };
+                ssize_t vcntxt_id = plic_plat_cntxt_to_id(vcntxt);
+                vplic_update_hart_line(vcpu, (size_t)vcntxt_id);
+            }
         } else {
             for (size_t i = 0; i < vplic->cntxt_num; i++) {
                 if (plic_plat_id_to_cntxt(i).mode != PRIV_S) {
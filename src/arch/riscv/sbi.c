@@ -11,6 +11,7 @@
 #include <fences.h>
 #include <hypercall.h>
 #include <interrupts.h>
+#include <arch/instructions.h>
 
 #define SBI_EXTID_BASE                  (0x10)
 #define SBI_GET_SBI_SPEC_VERSION_FID    (0)
@@ -183,7 +184,17 @@ static unsigned long ext_table[] = { SBI_EXTID_BASE, SBI_EXTID_TIME, SBI_EXTID_I
 
 static const size_t NUM_EXT = sizeof(ext_table) / sizeof(unsigned long);
 
-enum SBI_MSG_EVENTS { SEND_IPI, HART_START };
+/**
+ * Remote fence ranges spanning more than this number of pages are handled as a full flush of the
+ * address space instead of one invalidation per page.
+ */
+#ifndef SBI_RFENCE_MAX_PAGES
+#define SBI_RFENCE_MAX_PAGES (64)
+#endif
+
+enum SBI_MSG_EVENTS { SEND_IPI, HART_START, RFENCE };
+
+static void sbi_rfence_local(const struct sbi_rfence_req* req);
 
 void sbi_msg_handler(uint32_t event, uint64_t data);
 CPU_MSG_HANDLER(sbi_msg_handler, SBI_MSG_ID)
@@ -205,6 +216,17 @@ void sbi_msg_handler(uint32_t event, uint64_t data)
             }
             spin_unlock(&cpu()->vcpu->arch.sbi_ctx.lock);
         } break;
+        case RFENCE: {
+            struct sbi_rfence* rfence = &cpu()->vcpu->arch.rfence;
+            spin_lock(&rfence->lock);
+            struct sbi_rfence_req req = rfence->req;
+            size_t seq = rfence->req_seq;
+            rfence->pending = false;
+            spin_unlock(&rfence->lock);
+            sbi_rfence_local(&req);
+            fence_sync();
+            rfence->done_seq = seq;
+        } break;
         default:
             WARNING("unknown sbi msg\n");
             break;
@@ -224,6 +246,21 @@ static struct sbiret sbi_time_handler(unsigned long fid)
 
     if (CPU_HAS_EXTENSION(CPU_EXT_SSTC)) {
         csrs_vstimecmp_write(stime_value);
+    } else if (stime_value == ~0ULL) {
+        /**
+         * The guest is cancelling its timer. Masking the hypervisor timer interrupt is enough,
+         * as any stale firmware deadline is overwritten by the next set_timer.
+         */
+        csrs_sie_clear(SIE_STIE);
+        csrs_hvip_clear(HIP_VSTIP);
+    } else if (stime_value <= csrs_time_read()) {
+        /**
+         * The deadline already expired (htimedelta is zero, so guest and hypervisor time match).
+         * Inject the timer interrupt right away instead of round-tripping through the firmware
+         * and taking its timer interrupt.
+         */
+        csrs_sie_clear(SIE_STIE);
+        csrs_hvip_set(HIP_VSTIP);
     } else {
         sbi_set_timer(stime_value); // assumes always success
         csrs_hvip_clear(HIP_VSTIP);
@@ -257,7 +294,10 @@ static struct sbiret sbi_ipi_handler(unsigned long fid)
         if (bit_get(hart_mask, i)) {
             vcpuid_t vhart_id = hart_mask_base + i;
             cpuid_t phart_id = vm_translate_to_pcpuid(cpu()->vcpu->vm, vhart_id);
-            if (phart_id != INVALID_CPUID) {
+            if (phart_id == cpu()->id) {
+                /* Self IPIs are delivered directly, without a message round trip */
+                csrs_hvip_set(HIP_VSSIP);
+            } else if (phart_id != INVALID_CPUID) {
                 cpu_send_msg(phart_id, &msg);
             }
         }
@@ -293,15 +333,135 @@ static struct sbiret sbi_base_handler(unsigned long fid)
     return ret;
 }
 
-static struct sbiret sbi_rfence_handler(unsigned long fid)
+static void sbi_rfence_vvma_page(unsigned long va, const struct sbi_rfence_req* req)
 {
-    struct sbiret ret;
+    if (CPU_HAS_EXTENSION(CPU_EXT_SVINVAL)) {
+        if (req->all_asid) {
+            hinval_vvma_va(va);
+        } else {
+            hinval_vvma_va_asid(va, req->asid);
+        }
+    } else {
+        if (req->all_asid) {
+            hfence_vvma_va(va);
+        } else {
+            hfence_vvma_va_asid(va, req->asid);
+        }
+    }
+}
 
+/**
+ * Executes a remote fence request on the local hart. The VS-stage invalidations apply to the VMID
+ * currently in hgatp, i.e., the VM of the vcpu running on this cpu.
+ */
+static void sbi_rfence_local(const struct sbi_rfence_req* req)
+{
+    if (req->fence_i) {
+        fence_i();
+    }
+
+    if (!req->vma) {
+        return;
+    }
+
+    unsigned long start = ALIGN_FLOOR(req->start_addr, (unsigned long)PAGE_SIZE);
+    unsigned long offset = req->start_addr - start;
+    bool full = (req->start_addr == 0 && req->size == 0) ||
+        (req->size > ((SBI_RFENCE_MAX_PAGES * PAGE_SIZE) - offset));
+
+    if (full) {
+        if (req->all_asid) {
+            hfence_vvma_all();
+        } else {
+            hfence_vvma_asid(req->asid);
+        }
+    } else {
+        size_t num_pages = NUM_PAGES(offset + req->size);
+        if (CPU_HAS_EXTENSION(CPU_EXT_SVINVAL)) {
+            sfence_w_inval();
+        }
+        for (size_t i = 0; i < num_pages; i++) {
+            sbi_rfence_vvma_page(start + (i * PAGE_SIZE), req);
+        }
+        if (CPU_HAS_EXTENSION(CPU_EXT_SVINVAL)) {
+            sfence_inval_ir();
+        }
+    }
+}
+
+/**
+ * Posts a fence request to a remote vcpu. If the vcpu still has an unprocessed request, the new
+ * one is merged into it and no additional message is sent.
+ *
+ * @return the sequence number to wait on for the request to be completed
+ */
+static size_t sbi_rfence_post(struct vcpu* vcpu, const struct sbi_rfence_req* req)
+{
+    struct sbi_rfence* rfence = &vcpu->arch.rfence;
+    bool send = false;
+    size_t seq = 0;
+
+    spin_lock(&rfence->lock);
+    if (!rfence->pending) {
+        rfence->req = *req;
+        rfence->pending = true;
+        send = true;
+    } else {
+        rfence->req.fence_i |= req->fence_i;
+        if (req->vma && !rfence->req.vma) {
+            rfence->req.vma = true;
+            rfence->req.all_asid = req->all_asid;
+            rfence->req.start_addr = req->start_addr;
+            rfence->req.size = req->size;
+            rfence->req.asid = req->asid;
+        } else if (req->vma) {
+            if (req->start_addr != rfence->req.start_addr || req->size != rfence->req.size) {
+                rfence->req.start_addr = 0;
+                rfence->req.size = ULONG_MAX;
+            }
+            if (req->all_asid || req->asid != rfence->req.asid) {
+                rfence->req.all_asid = true;
+            }
+        }
+    }
+    seq = ++rfence->req_seq;
+    spin_unlock(&rfence->lock);
+
+    if (send) {
+        struct cpu_msg msg = {
+            .handler = (uint32_t)SBI_MSG_ID,
+            .event = RFENCE,
+        };
+        cpu_send_msg(vcpu->phys_id, &msg);
+    }
+
+    return seq;
+}
+
+/**
+ * Waits for a remote vcpu to complete a fence request. Incoming messages are handled while
+ * waiting, so that two harts fencing each other do not deadlock.
+ */
+static void sbi_rfence_wait(struct vcpu* vcpu, size_t seq)
+{
+    while (vcpu->arch.rfence.done_seq < seq) {
+        if (interrupts_ipi_check()) {
+            interrupts_ipi_clear();
+            cpu_msg_handler();
+        }
+    }
+}
+
+static struct sbiret sbi_rfence_handler(unsigned long fid)
+{
     unsigned long hart_mask = vcpu_readreg(cpu()->vcpu, REG_A0);
     unsigned long hart_mask_base = vcpu_readreg(cpu()->vcpu, REG_A1);
-    unsigned long start_addr = vcpu_readreg(cpu()->vcpu, REG_A2);
-    unsigned long size = vcpu_readreg(cpu()->vcpu, REG_A3);
-    unsigned long asid = vcpu_readreg(cpu()->vcpu, REG_A4);
+    struct sbi_rfence_req req = {
+        .start_addr = vcpu_readreg(cpu()->vcpu, REG_A2),
+        .size = vcpu_readreg(cpu()->vcpu, REG_A3),
+        .asid = vcpu_readreg(cpu()->vcpu, REG_A4),
+    };
+    size_t seqs[sizeof(hart_mask) * 8];
 
     const size_t hart_mask_width = sizeof(hart_mask) * 8;
     if ((hart_mask_base != 0) &&
@@ -312,24 +472,46 @@ static struct sbiret sbi_rfence_handler(unsigned long fid)
 
     hart_mask = hart_mask << hart_mask_base;
 
-    unsigned long phart_mask =
-        vm_translate_to_pcpu_mask(cpu()->vcpu->vm, hart_mask, sizeof(hart_mask) * 8);
-
     switch (fid) {
         case SBI_REMOTE_FENCE_I_FID:
-            ret = sbi_remote_fence_i(phart_mask, 0);
+            req.fence_i = true;
             break;
         case SBI_REMOTE_SFENCE_VMA_FID:
-            ret = sbi_remote_hfence_vvma(phart_mask, 0, start_addr, size);
+            req.vma = true;
+            req.all_asid = true;
             break;
         case SBI_REMOTE_SFENCE_VMA_ASID_FID:
-            ret = sbi_remote_hfence_vvma_asid(phart_mask, 0, start_addr, size, asid);
+            req.vma = true;
             break;
         default:
-            ret.error = SBI_ERR_NOT_SUPPORTED;
+            return (struct sbiret){ SBI_ERR_NOT_SUPPORTED, 0 };
     }
 
-    return ret;
+    /**
+     * Post the request to all targets before waiting on any of them, so that remote harts execute
+     * their fences in parallel. The local hart executes its fence directly.
+     */
+    for (size_t i = 0; i < hart_mask_width; i++) {
+        if (bit_get(hart_mask, i)) {
+            struct vcpu* vcpu = vm_get_vcpu(cpu()->vcpu->vm, (vcpuid_t)i);
+            if (vcpu == cpu()->vcpu) {
+                sbi_rfence_local(&req);
+            } else if (vcpu != NULL) {
+                seqs[i] = sbi_rfence_post(vcpu, &req);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < hart_mask_width; i++) {
+        if (bit_get(hart_mask, i)) {
+            struct vcpu* vcpu = vm_get_vcpu(cpu()->vcpu->vm, (vcpuid_t)i);
+            if (vcpu != NULL && vcpu != cpu()->vcpu) {
+                sbi_rfence_wait(vcpu, seqs[i]);
+            }
+        }
+    }
+
+    return (struct sbiret){ SBI_SUCCESS, 0 };
 }
 
 static struct sbiret sbi_hsm_start_handler(void)
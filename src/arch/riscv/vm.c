@@ -30,6 +30,7 @@ void vcpu_arch_init(struct vcpu* vcpu, struct vm* vm)
 
     vcpu->arch.sbi_ctx.lock = SPINLOCK_INITVAL;
     vcpu->arch.sbi_ctx.state = vcpu->id == 0 ? STARTED : STOPPED;
+    vcpu->arch.rfence = (struct sbi_rfence){ .lock = SPINLOCK_INITVAL };
 }
 
 void vcpu_arch_reset(struct vcpu* vcpu, vaddr_t entry)
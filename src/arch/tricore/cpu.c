@@ -13,9 +13,28 @@
 
 cpuid_t CPU_MASTER __attribute__((section(".data")));
 
+/* The CSA high-water mark is checked whenever the core recycles its CSA chain on standby or
+powerdown, and reported when it has grown */
+static void cpu_csa_stats_report(unsigned long core_id)
+{
+    static size_t reported[PLAT_CPU_NUM];
+
+    if (DEFINED(STATS)) {
+        size_t mark = csa_high_watermark(core_id);
+        if (mark > reported[core_id]) {
+            reported[core_id] = mark;
+            INFO("csa: core %lu high watermark %lu of %lu entries\n", core_id,
+                (unsigned long)mark, (unsigned long)(CSA_ENTRIES - 1));
+        }
+    }
+}
+
 static inline void cpu_reset_csa(void)
 {
     unsigned long core_id = csfr_coreid_read() & COREID_CORE_MASK;
+
+    cpu_csa_stats_report(core_id);
+
     unsigned long old_fcx = csfr_fcx_read();
     unsigned long old_pcxi = csfr_pcxi_read();
 
@@ -7,3 +7,18 @@
 #include <arch/csa.h>
 
 union csa csa_array[PLAT_CPU_NUM][CSA_ENTRIES] __attribute__((aligned(64)));
+
+size_t csa_high_watermark(unsigned long core_id)
+{
+    /* csa_array lives in bss and the boot-time free list only links the
+    first word of each entry. Every frame the hardware stores writes the
+    second word (lower a11 or upper psw), so the highest entry with that word
+    set marks the deepest nesting reached. Index 0 is never used. */
+    for (size_t i = CSA_ENTRIES - 1; i > 0; i--) {
+        if (csa_array[core_id][i].lower.a11 != 0) {
+            return i;
+        }
+    }
+
+    return 0;
+}
@@ -8,7 +8,9 @@
 
 #include <bao.h>
 
-#define CSA_ENTRIES       32
+#ifndef CSA_ENTRIES
+#define CSA_ENTRIES 32
+#endif
 #define CSA_SIZE          16
 #define CSA_SIZE_BYTES    (16 * 4)
 #define CSA_ARRAY_SIZE    (CSA_ENTRIES * CSA_SIZE * 4)
@@ -71,6 +73,15 @@ union csa {
 
 extern union csa csa_array[PLAT_CPU_NUM][CSA_ENTRIES];
 
+/**
+ * Returns the deepest CSA index ever handed out on the given core. Since the
+ * hardware pops and pushes frames in LIFO order, this is the maximum call and
+ * trap nesting depth observed so far and can be used to right-size
+ * CSA_ENTRIES for a given configuration. Like csa_array, it is indexed by the
+ * CORE_ID core number, which is not necessarily the bao cpu id.
+ */
+size_t csa_high_watermark(unsigned long core_id);
+
 #endif
 
 #endif /*__CSA_H__ */
@@ -18,6 +18,24 @@ static size_t ipi_cpumsg_handler_num;
 
 struct cpuif cpu_interfaces[PLAT_CPU_NUM];
 
+/**
+ * Per-sender multicast message descriptors. A single message is shared by all its targets, each
+ * of which consumes it by clearing its own pending flag.
+ *
+ * Messages from the same sender are delivered in the order they were sent. A target drains its
+ * queue before consuming multicast descriptors, so a multicast is only published to targets whose
+ * queue is empty; the others get it queued. Before a sender queues a new message to a target the
+ * descriptor is still pending for, it moves the pending multicast to that queue first. The lock
+ * makes that hand-over exclusive with the target consuming the descriptor.
+ */
+struct cpu_mcast_msg {
+    spinlock_t lock;
+    struct cpu_msg msg;
+    volatile bool pending[PLAT_CPU_NUM];
+};
+
+static struct cpu_mcast_msg cpu_mcast_msgs[PLAT_CPU_NUM];
+
 void cpu_init(cpuid_t cpu_id)
 {
     cpu()->id = cpu_id;
@@ -27,6 +45,7 @@ void cpu_init(cpuid_t cpu_id)
     cpu_arch_init(cpu_id, img_addr);
 
     CQ_INIT(cpu()->interface, msgs);
+    cpu_mcast_msgs[cpu_id].lock = SPINLOCK_INITVAL;
 
     if (cpu_is_master()) {
         cpu_sync_init(&cpu_glb_sync, platform.cpu_num);
@@ -41,14 +60,84 @@ void cpu_init(cpuid_t cpu_id)
     cpu_sync_barrier(&cpu_glb_sync);
 }
 
-void cpu_send_msg(cpuid_t trgtcpu, struct cpu_msg* msg)
+static bool cpu_push_msg(cpuid_t trgtcpu, struct cpu_msg* msg)
 {
     bool ok = circular_queue_push(&cpu_if(trgtcpu)->msgs, msg);
-    if (ok) {
+    if (!ok) {
+        WARNING("Can't add message to target cpu (%d) interface\n", trgtcpu);
+    }
+    return ok;
+}
+
+/* Must be called with the descriptor lock held. Returns true if a message was queued. */
+static bool cpu_mcast_requeue(struct cpu_mcast_msg* mcast, cpuid_t trgtcpu)
+{
+    bool queued = false;
+    if (mcast->pending[trgtcpu]) {
+        mcast->pending[trgtcpu] = false;
+        queued = cpu_push_msg(trgtcpu, &mcast->msg);
+    }
+    return queued;
+}
+
+void cpu_send_msg(cpuid_t trgtcpu, struct cpu_msg* msg)
+{
+    struct cpu_mcast_msg* mcast = &cpu_mcast_msgs[cpu()->id];
+    bool queued = false;
+
+    /* Only the sender sets its pending flags, so a clear flag needs no locking */
+    if (mcast->pending[trgtcpu]) {
+        spin_lock(&mcast->lock);
+        queued = cpu_mcast_requeue(mcast, trgtcpu);
+        spin_unlock(&mcast->lock);
+    }
+
+    if (cpu_push_msg(trgtcpu, msg) || queued) {
         fence_sync_write();
         interrupts_cpu_sendipi(trgtcpu);
-    } else {
-        WARNING("Can't add message to target cpu (%d) interface\n", trgtcpu);
+    }
+}
+
+void cpu_send_msg_multicast(cpumap_t trgtcpus, struct cpu_msg* msg)
+{
+    struct cpu_mcast_msg* mcast = &cpu_mcast_msgs[cpu()->id];
+    cpumap_t ipi_cpus = 0;
+
+    spin_lock(&mcast->lock);
+
+    /**
+     * Targets still holding the previous message get it queued so the descriptor can be reused.
+     * They may have already handled the IPI that announced it, so they are interrupted again.
+     */
+    for (cpuid_t i = 0; i < platform.cpu_num; i++) {
+        if (cpu_mcast_requeue(mcast, i)) {
+            ipi_cpus |= (cpumap_t)1 << i;
+        }
+    }
+
+    mcast->msg = *msg;
+    fence_sync_write();
+    for (cpuid_t i = 0; i < platform.cpu_num; i++) {
+        if (!(trgtcpus & ((cpumap_t)1 << i))) {
+            continue;
+        }
+        struct circular_queue* msgs = &cpu_if(i)->msgs;
+        spin_lock(&msgs->lock);
+        bool queue_empty = circular_queue_is_empty(msgs);
+        spin_unlock(&msgs->lock);
+        if (queue_empty) {
+            mcast->pending[i] = true;
+            ipi_cpus |= (cpumap_t)1 << i;
+        } else if (cpu_push_msg(i, msg)) {
+            ipi_cpus |= (cpumap_t)1 << i;
+        }
+    }
+
+    spin_unlock(&mcast->lock);
+
+    if (ipi_cpus != 0) {
+        fence_sync_write();
+        interrupts_cpu_sendipi_mask(ipi_cpus);
     }
 }
 
@@ -57,13 +146,34 @@ bool cpu_get_msg(struct cpu_msg* msg)
     return circular_queue_pop(&cpu()->interface->msgs, msg);
 }
 
+static inline void cpu_msg_dispatch(struct cpu_msg* msg)
+{
+    if (msg->handler < ipi_cpumsg_handler_num && ipi_cpumsg_handlers[msg->handler]) {
+        ipi_cpumsg_handlers[msg->handler](msg->event, msg->data);
+    }
+}
+
 void cpu_msg_handler(void)
 {
     cpu()->handling_msgs = true;
     struct cpu_msg msg;
     while (cpu_get_msg(&msg)) {
-        if (msg.handler < ipi_cpumsg_handler_num && ipi_cpumsg_handlers[msg.handler]) {
-            ipi_cpumsg_handlers[msg.handler](msg.event, msg.data);
+        cpu_msg_dispatch(&msg);
+    }
+    for (cpuid_t i = 0; i < platform.cpu_num; i++) {
+        struct cpu_mcast_msg* mcast = &cpu_mcast_msgs[i];
+        bool consumed = false;
+        if (mcast->pending[cpu()->id]) {
+            spin_lock(&mcast->lock);
+            if (mcast->pending[cpu()->id]) {
+                msg = mcast->msg;
+                mcast->pending[cpu()->id] = false;
+                consumed = true;
+            }
+            spin_unlock(&mcast->lock);
+        }
+        if (consumed) {
+            cpu_msg_dispatch(&msg);
         }
     }
     cpu()->handling_msgs = false;
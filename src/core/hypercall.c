@@ -4,20 +4,38 @@
  */
 
 #include <hypercall.h>
+#include <cpu.h>
+
+extern struct hypercall_entry _hypercall_handlers_start[];
+extern struct hypercall_entry _hypercall_handlers_end[];
+
+static hypercall_handler_t hypercall_table[HC_NUM];
+
+void hypercall_init(void)
+{
+    if (cpu_is_master()) {
+        size_t entry_num = (size_t)(_hypercall_handlers_end - _hypercall_handlers_start);
+        for (size_t i = 0; i < entry_num; i++) {
+            struct hypercall_entry* entry = &_hypercall_handlers_start[i];
+            if (entry->id == HC_INVAL || entry->id >= HC_NUM) {
+                ERROR("invalid hypercall id %d registered\n", entry->id);
+            }
+            if (hypercall_table[entry->id] != NULL) {
+                ERROR("hypercall id %d registered more than once\n", entry->id);
+            }
+            hypercall_table[entry->id] = entry->handler;
+        }
+    }
+}
 
 long int hypercall(unsigned long id)
 {
     long int ret = -HC_E_INVAL_ID;
 
-    switch (id) {
-        case HC_IPC:
-            ret = ipc_hypercall();
-            break;
-        case HC_REMIO:
-            ret = remio_hypercall();
-            break;
-        default:
-            WARNING("Unknown hypercall id %d\n", id);
+    if (id < HC_NUM && hypercall_table[id] != NULL) {
+        ret = hypercall_table[id]();
+    } else {
+        WARNING("Unknown hypercall id %d\n", id);
     }
 
     return ret;
@@ -10,12 +10,29 @@
 #include <arch/hypercall.h>
 #include <vm.h>
 
-enum { HC_INVAL = 0, HC_IPC = 1, HC_REMIO = 2 };
+enum { HC_INVAL = 0, HC_IPC = 1, HC_REMIO = 2, HC_NUM };
 
 enum { HC_E_SUCCESS = 0, HC_E_FAILURE = 1, HC_E_INVAL_ID = 2, HC_E_INVAL_ARGS = 3 };
 
-typedef unsigned long (*hypercall_handler)(void);
+typedef long int (*hypercall_handler_t)(void);
 
+struct hypercall_entry {
+    unsigned long id;
+    hypercall_handler_t handler;
+};
+
+/**
+ * Registers a hypercall handler for the given id. Entries are collected in the .hypercall_handlers
+ * section and indexed into the dispatch table by hypercall_init.
+ */
+#define HYPERCALL_HANDLER(hc_handler, hc_id)                                \
+    __attribute__((section(".hypercall_handlers"),                          \
+        used)) static const struct hypercall_entry __hypercall_##hc_handler = { \
+        .id = (hc_id),                                                      \
+        .handler = (hc_handler),                                            \
+    };
+
+void hypercall_init(void);
 long int hypercall(unsigned long id);
 
 static inline unsigned long hypercall_get_arg(struct vcpu* vcpu, size_t arg_index)
@@ -15,11 +15,71 @@ struct ipc {
     size_t shmem_id;
     size_t interrupt_num;
     irqid_t* interrupts;
+
+    /**
+     * Notifications to this IPC object are delivered to a single vCPU of the VM. By default, this
+     * is the vCPU running on the CPU that initialized the VM. If route_vcpu is set, they are
+     * delivered to target_vcpu instead.
+     */
+    bool route_vcpu;
+    vcpuid_t target_vcpu;
+
+    /* The following fields are used for book keeping only, don't fill them in the configuration */
+    struct vm* vm;
+    cpuid_t target_cpu;
+    spinlock_t lock;
+    unsigned long pending;
+};
+
+/**
+ * Optional ring transport over an IPC shared memory region. When a ring is configured for a shared
+ * memory, the hypervisor places the following header at the base of the region at boot. Slots
+ * start at slots_offset and indices are free-running, i.e., the slot for index i is
+ * i & (slot_num - 1).
+ *
+ * The producer publishes entries by advancing prod.idx and then notifying IPC_RING_EVENT_DATA.
+ * The consumer frees slots by advancing cons.idx and then notifying IPC_RING_EVENT_SPACE. Each side
+ * states in its event field the index after which it wants to be notified next. The hypervisor
+ * only delivers a notification if the index moved past that event index since the last delivered
+ * one, so that either side can batch entries and call the doorbell freely.
+ */
+#define IPC_RING_MAGIC   (0x474e4952) /* "RING" */
+#define IPC_RING_VERSION (1)
+#define IPC_RING_ALIGN   (64)
+
+enum { IPC_RING_EVENT_DATA = 0, IPC_RING_EVENT_SPACE = 1 };
+
+struct ipc_ring_hdr {
+    /* Written by the hypervisor at boot */
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_num;
+    uint32_t slot_size;
+    uint32_t slots_offset;
+
+    /* Written by the hypervisor on each doorbell */
+    volatile uint32_t notify_delivered;
+    volatile uint32_t notify_suppressed;
+
+    /* Written by the producer */
+    struct {
+        volatile uint32_t idx;
+        volatile uint32_t space_event;
+    } prod __attribute__((aligned(IPC_RING_ALIGN)));
+
+    /* Written by the consumer */
+    struct {
+        volatile uint32_t idx;
+        volatile uint32_t data_event;
+    } cons __attribute__((aligned(IPC_RING_ALIGN)));
 };
 
 struct vm_config;
+struct vm;
+struct shmem;
 
 long int ipc_hypercall(void);
 void ipc_init(void);
+void ipc_vm_register(struct vm* vm, struct ipc* ipc, struct shmem* shmem);
 
 #endif /* IPC_H */
@@ -0,0 +1,32 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#ifndef __PAGE_POOL_H__
+#define __PAGE_POOL_H__
+
+#include <bao.h>
+#include <list.h>
+#include <spinlock.h>
+#include <bitmap.h>
+
+struct ppages {
+    paddr_t base;
+    size_t num_pages;
+    colormap_t colors;
+};
+
+struct page_pool {
+    node_t node;
+    paddr_t base;
+    size_t num_pages;
+    size_t free;
+    size_t last;
+    bitmap_t* bitmap;
+    spinlock_t lock;
+};
+
+bool pp_alloc(struct page_pool* pool, size_t num_pages, bool aligned, struct ppages* ppages);
+
+#endif /* __PAGE_POOL_H__ */
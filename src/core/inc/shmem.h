@@ -7,6 +7,10 @@
 #define SHMEM_H
 
 #include <mem.h>
+#include <config_defs.h>
+
+struct ipc;
+struct ipc_ring_hdr;
 
 struct shmem {
     size_t size;
@@ -17,8 +21,26 @@ struct shmem {
         paddr_t phys;
     };
     bool reserved;
+
+    /**
+     * Set slot_num (a power of two) and slot_size to have the hypervisor set up a ring transport
+     * (struct ipc_ring_hdr) at the base of the region. See ipc.h.
+     */
+    struct {
+        size_t slot_num;
+        size_t slot_size;
+    } ring;
+
+    /* The following fields are used for book keeping only, don't fill them in the configuration */
     cpumap_t cpu_masters;
     spinlock_t lock;
+    /* IPC object notified on each VM mapping this region, indexed by VM id */
+    struct ipc* ipcs[CONFIG_VM_NUM];
+    struct ipc_ring_hdr* ring_hdr;
+    uint32_t ring_notified_prod;
+    uint32_t ring_notified_cons;
+    size_t ring_delivered;
+    size_t ring_suppressed;
 };
 
 void shmem_init(void);
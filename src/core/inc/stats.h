@@ -0,0 +1,36 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include <bao.h>
+
+/**
+ * Event counters for tuning the hypervisor. They are only updated in builds with STATS=y, which
+ * also makes each subsystem print its counters every STATS_REPORT_PERIOD events. In other builds
+ * both the updates and the reports compile to nothing.
+ */
+
+#ifndef STATS_REPORT_PERIOD
+#define STATS_REPORT_PERIOD (1024)
+#endif
+
+#define STATS_ADD(counter, n) \
+    do {                      \
+        if (DEFINED(STATS)) { \
+            (counter) += (n); \
+        }                     \
+    } while (0)
+
+#define STATS_INC(counter) STATS_ADD(counter, 1)
+
+/* Returns true once every STATS_REPORT_PERIOD events counted by count */
+static inline bool stats_report_due(unsigned long count)
+{
+    return DEFINED(STATS) && ((count % (unsigned long)STATS_REPORT_PERIOD) == 0);
+}
+
+#endif /* __STATS_H__ */
@@ -18,6 +18,7 @@
 #include <io.h>
 #include <ipc.h>
 #include <remio.h>
+#include <config_defs.h>
 
 struct vm_mem_region {
     paddr_t base;
@@ -91,6 +92,7 @@ struct vm {
 
     size_t ipc_num;
     struct ipc* ipcs;
+    struct ipc* ipc_by_shmem[CONFIG_SHMEM_NUM];
 
     size_t remio_dev_num;
     struct remio_dev* remio_devs;
@@ -174,6 +176,7 @@ static inline void vcpu_inject_irq(struct vcpu* vcpu, irqid_t id)
 /* ------------------------------------------------------------*/
 
 void vm_mem_prot_init(struct vm* vm, const struct vm_config* config);
+void vm_mem_prot_add_dev(struct vm* vm, struct vm_dev_region* dev);
 
 /* ------------------------------------------------------------*/
 
@@ -9,6 +9,7 @@
 #include <vm.h>
 #include <bitmap.h>
 #include <string.h>
+#include <platform.h>
 
 BITMAP_ALLOC(global_interrupt_bitmap, MAX_INTERRUPT_LINES);
 spinlock_t irq_reserve_lock = SPINLOCK_INITVAL;
@@ -22,6 +23,11 @@ void interrupts_cpu_sendipi(cpuid_t target_cpu)
     interrupts_arch_ipi_send(target_cpu);
 }
 
+void interrupts_cpu_sendipi_mask(cpumap_t target_cpus)
+{
+    interrupts_arch_ipi_send_mask(target_cpus);
+}
+
 void interrupts_cpu_enable(irqid_t int_id, bool en)
 {
     interrupts_arch_enable(int_id, en);
@@ -37,6 +43,15 @@ void interrupts_cpu_enable(irqid_t int_id, bool en)
     at the architectural level.
 */
 
+__attribute__((weak)) void interrupts_arch_ipi_send_mask(cpumap_t cpu_targets)
+{
+    for (cpuid_t i = 0; i < platform.cpu_num; i++) {
+        if (cpu_targets & ((cpumap_t)1 << i)) {
+            interrupts_arch_ipi_send(i);
+        }
+    }
+}
+
 __attribute__((weak)) bool interrupts_ipi_check(void)
 {
     return interrupts_arch_check(interrupts_ipi_id);
@@ -10,6 +10,8 @@
 #include <hypercall.h>
 #include <config.h>
 #include <shmem.h>
+#include <string.h>
+#include <fences.h>
 
 enum { IPC_NOTIFY };
 
@@ -21,24 +23,56 @@ union ipc_msg_data {
     uint64_t raw;
 };
 
-static struct ipc* ipc_find_by_shmemid(struct vm* vm, size_t shmem_id)
+/**
+ * Only events that fit in the pending word of an IPC object are coalesced. Notifications for any
+ * other event always result in a message to the target CPU.
+ */
+#define IPC_COALESCED_EVENTS (sizeof(unsigned long) * 8)
+
+static inline struct ipc* ipc_find_by_shmemid(struct vm* vm, size_t shmem_id)
 {
-    struct ipc* ipc_obj = NULL;
+    if (shmem_id < CONFIG_SHMEM_NUM) {
+        return vm->ipc_by_shmem[shmem_id];
+    }
+    return NULL;
+}
 
-    for (size_t i = 0; i < vm->ipc_num; i++) {
-        if (vm->ipcs[i].shmem_id == shmem_id) {
-            ipc_obj = &vm->ipcs[i];
-            break;
-        }
+/**
+ * Marks the event as pending on the target IPC object. Returns false if it was already pending,
+ * in which case the in-flight notification will also cover this one.
+ */
+static bool ipc_event_set_pending(struct ipc* ipc_obj, size_t event_id)
+{
+    bool set = true;
+
+    if (event_id < IPC_COALESCED_EVENTS) {
+        spin_lock(&ipc_obj->lock);
+        set = !bit_get(ipc_obj->pending, event_id);
+        ipc_obj->pending = bit_set(ipc_obj->pending, event_id);
+        spin_unlock(&ipc_obj->lock);
     }
 
-    return ipc_obj;
+    return set;
+}
+
+static void ipc_event_clear_pending(struct ipc* ipc_obj, size_t event_id)
+{
+    if (event_id < IPC_COALESCED_EVENTS) {
+        spin_lock(&ipc_obj->lock);
+        ipc_obj->pending = bit_clear(ipc_obj->pending, event_id);
+        spin_unlock(&ipc_obj->lock);
+    }
 }
 
 static void ipc_notify(size_t shmem_id, size_t event_id)
 {
     struct ipc* ipc_obj = ipc_find_by_shmemid(cpu()->vcpu->vm, shmem_id);
     if (ipc_obj != NULL && event_id < ipc_obj->interrupt_num) {
+        /**
+         * Clear the pending event before injecting, so that a notification issued after this
+         * point is not lost, while those issued before are covered by this injection.
+         */
+        ipc_event_clear_pending(ipc_obj, event_id);
         irqid_t irq_id = ipc_obj->interrupts[event_id];
         vcpu_inject_irq(cpu()->vcpu, irq_id);
     }
@@ -58,6 +92,138 @@ static void ipc_handler(uint32_t event, uint64_t data)
 }
 CPU_MSG_HANDLER(ipc_handler, IPC_CPUMSG_ID)
 
+static inline size_t ipc_ring_hdr_size(void)
+{
+    return ALIGN(sizeof(struct ipc_ring_hdr), IPC_RING_ALIGN);
+}
+
+static inline size_t ipc_ring_size(struct shmem* shmem)
+{
+    return ipc_ring_hdr_size() + (shmem->ring.slot_num * shmem->ring.slot_size);
+}
+
+static void ipc_ring_init(struct shmem* shmem, size_t shmem_id)
+{
+    size_t slot_num = shmem->ring.slot_num;
+    size_t slot_size = shmem->ring.slot_size;
+
+    bool valid_slots = ((slot_num & (slot_num - 1)) == 0) && (slot_size != 0) &&
+        IS_ALIGNED(slot_size, sizeof(uint32_t)) && ((size_t)(uint32_t)slot_num == slot_num) &&
+        ((size_t)(uint32_t)slot_size == slot_size);
+    bool fits_shmem = (shmem->size >= ipc_ring_hdr_size()) &&
+        (slot_num <= ((shmem->size - ipc_ring_hdr_size()) / max(slot_size, 1UL)));
+    if (!valid_slots || !fits_shmem) {
+        ERROR("Invalid ring configuration for shared memory %lu\n", (unsigned long)shmem_id);
+    }
+
+    size_t n = NUM_PAGES(sizeof(struct ipc_ring_hdr));
+    struct ppages ppages = mem_ppages_get(shmem->phys, n);
+    ppages.colors = shmem->colors;
+    vaddr_t va = mem_alloc_map(&cpu()->as, SEC_HYP_GLOBAL, &ppages, INVALID_VA, n, PTE_HYP_FLAGS);
+    if (va == INVALID_VA) {
+        ERROR("Failed to map ring of shared memory %lu\n", (unsigned long)shmem_id);
+    }
+
+    struct ipc_ring_hdr* hdr = (struct ipc_ring_hdr*)va;
+    memset(hdr, 0, sizeof(struct ipc_ring_hdr));
+    hdr->version = IPC_RING_VERSION;
+    hdr->slot_num = (uint32_t)slot_num;
+    hdr->slot_size = (uint32_t)slot_size;
+    hdr->slots_offset = (uint32_t)ipc_ring_hdr_size();
+    fence_ord_write();
+    hdr->magic = IPC_RING_MAGIC;
+
+    shmem->ring_hdr = hdr;
+    shmem->ring_notified_prod = 0;
+    shmem->ring_notified_cons = 0;
+    shmem->ring_delivered = 0;
+    shmem->ring_suppressed = 0;
+}
+
+/**
+ * Applies the event index rule to a ring doorbell. Returns false if the notification can be
+ * suppressed as the other side did not ask to be notified for the index range published since the
+ * index seen at the previous check, whether or not that check delivered a notification.
+ */
+static bool ipc_ring_need_notify(struct shmem* shmem, unsigned long event)
+{
+    struct ipc_ring_hdr* hdr = shmem->ring_hdr;
+    uint32_t new_idx = 0;
+    uint32_t old_idx = 0;
+    uint32_t event_idx = 0;
+    bool need = true;
+
+    if (hdr == NULL || (event != IPC_RING_EVENT_DATA && event != IPC_RING_EVENT_SPACE)) {
+        return true;
+    }
+
+    spin_lock(&shmem->lock);
+    if (event == IPC_RING_EVENT_DATA) {
+        new_idx = hdr->prod.idx;
+        event_idx = hdr->cons.data_event;
+        old_idx = shmem->ring_notified_prod;
+        shmem->ring_notified_prod = new_idx;
+    } else {
+        new_idx = hdr->cons.idx;
+        event_idx = hdr->prod.space_event;
+        old_idx = shmem->ring_notified_cons;
+        shmem->ring_notified_cons = new_idx;
+    }
+
+    need = (uint32_t)(new_idx - event_idx - 1) < (uint32_t)(new_idx - old_idx);
+    if (need) {
+        shmem->ring_delivered++;
+        hdr->notify_delivered = (uint32_t)shmem->ring_delivered;
+    } else {
+        shmem->ring_suppressed++;
+        hdr->notify_suppressed = (uint32_t)shmem->ring_suppressed;
+    }
+    spin_unlock(&shmem->lock);
+
+    return need;
+}
+
+void ipc_init(void)
+{
+    if (cpu_is_master()) {
+        for (size_t i = 0; i < config.shmemlist_size; i++) {
+            struct shmem* shmem = shmem_get(i);
+            shmem->ring_hdr = NULL;
+            if (shmem->ring.slot_num != 0) {
+                ipc_ring_init(shmem, i);
+            }
+        }
+    }
+}
+
+void ipc_vm_register(struct vm* vm, struct ipc* ipc, struct shmem* shmem)
+{
+    if (shmem->ring_hdr != NULL && ipc->size < ipc_ring_size(shmem)) {
+        ERROR("IPC object of shared memory %lu is smaller than its ring\n",
+            (unsigned long)ipc->shmem_id);
+    }
+
+    ipc->vm = vm;
+    ipc->lock = SPINLOCK_INITVAL;
+    ipc->pending = 0;
+    ipc->target_cpu = cpu()->id;
+
+    if (ipc->route_vcpu) {
+        cpuid_t target_cpu = vm_translate_to_pcpuid(vm, ipc->target_vcpu);
+        if (target_cpu != INVALID_CPUID) {
+            ipc->target_cpu = target_cpu;
+        } else {
+            WARNING("Invalid IPC target vcpu %lu. Ignored.\n", ipc->target_vcpu);
+        }
+    }
+
+    /* Only the first IPC object of a VM mapping a given shared memory is notified */
+    if (vm->ipc_by_shmem[ipc->shmem_id] == NULL) {
+        vm->ipc_by_shmem[ipc->shmem_id] = ipc;
+        shmem->ipcs[vm->id] = ipc;
+    }
+}
+
 long int ipc_hypercall(void)
 {
     unsigned long ipc_id = hypercall_get_arg(cpu()->vcpu, 0);
@@ -73,7 +239,9 @@ long int ipc_hypercall(void)
     bool valid_shmem = shmem != NULL;
 
     if (valid_ipc_obj && valid_shmem) {
-        cpumap_t ipc_cpu_masters = shmem->cpu_masters & ~cpu()->vcpu->vm->cpus;
+        if (!ipc_ring_need_notify(shmem, ipc_event)) {
+            return ret;
+        }
 
         union ipc_msg_data data = {
             .shmem_id = (uint32_t)cpu()->vcpu->vm->ipcs[ipc_id].shmem_id,
@@ -81,9 +249,14 @@ long int ipc_hypercall(void)
         };
         struct cpu_msg msg = { (uint32_t)IPC_CPUMSG_ID, IPC_NOTIFY, data.raw };
 
-        for (size_t i = 0; i < platform.cpu_num; i++) {
-            if (ipc_cpu_masters & (1ULL << i)) {
-                cpu_send_msg(i, &msg);
+        for (size_t i = 0; i < CONFIG_VM_NUM; i++) {
+            struct ipc* peer_ipc = shmem->ipcs[i];
+            if (peer_ipc == NULL || peer_ipc->vm == cpu()->vcpu->vm ||
+                ipc_event >= peer_ipc->interrupt_num) {
+                continue;
+            }
+            if (ipc_event_set_pending(peer_ipc, ipc_event)) {
+                cpu_send_msg(peer_ipc->target_cpu, &msg);
             }
         }
 
@@ -93,3 +266,5 @@ long int ipc_hypercall(void)
 
     return ret;
 }
+
+HYPERCALL_HANDLER(ipc_hypercall, HC_IPC)
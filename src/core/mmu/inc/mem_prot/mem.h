@@ -24,4 +24,8 @@ typedef pte_t mem_flags_t;
 void as_init(struct addr_space* as, enum AS_TYPE type, pte_t* root_pt, colormap_t colors);
 vaddr_t mem_alloc_vpage(struct addr_space* as, as_sec_t section, vaddr_t at, size_t n);
 
+/* Page tables are shared between cpus, so there are no mapping updates to batch */
+static inline void mem_batch_begin(void) { }
+static inline void mem_batch_commit(void) { }
+
 #endif /* __MEM_PROT_H__ */
@@ -12,3 +12,11 @@ void vm_mem_prot_init(struct vm* vm, const struct vm_config* vm_config)
 {
     as_init(&vm->as, AS_VM, NULL, vm_config->colors);
 }
+
+void vm_mem_prot_add_dev(struct vm* vm, struct vm_dev_region* dev)
+{
+    if (dev->va != INVALID_VA) {
+        size_t n = ALIGN(dev->size, PAGE_SIZE) / PAGE_SIZE;
+        mem_alloc_map_dev(&vm->as, SEC_VM_ANY, (vaddr_t)dev->va, dev->pa, n);
+    }
+}
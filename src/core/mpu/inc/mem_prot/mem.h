@@ -12,7 +12,10 @@
 #include <arch/mem.h>
 #include <arch/spinlock.h>
 
+#ifndef VMPU_NUM_ENTRIES
 #define VMPU_NUM_ENTRIES 64
+#endif
+
 struct mp_region {
     vaddr_t base;
     size_t size;
@@ -33,6 +36,9 @@ struct addr_space {
             struct mp_region region;
             mpid_t mpid;
         } node[VMPU_NUM_ENTRIES];
+        /* Valid entries sorted by base address, for binary search lookups */
+        mpid_t sorted[VMPU_NUM_ENTRIES];
+        size_t sorted_num;
     } vmpu;
     spinlock_t lock;
 };
@@ -41,11 +47,22 @@ void as_init(struct addr_space* as, enum AS_TYPE type, colormap_t colors);
 
 static inline bool mem_regions_overlap(struct mp_region* reg1, struct mp_region* reg2)
 {
-    return range_in_range(reg1->base, reg1->size, reg2->base, reg2->size);
+    return range_overlap_range(reg1->base, reg1->size, reg2->base, reg2->size);
 }
 
 bool mem_map(struct addr_space* as, struct mp_region* mpr, bool broadcast, bool locked);
 void mem_mmio_init_regions(struct addr_space* as);
+bool mem_demand_map(struct addr_space* as, vaddr_t addr);
+
+/**
+ * Between mem_batch_begin and mem_batch_commit, region updates that must be propagated to other
+ * cpus are accumulated locally. A removal cancels an earlier insertion of the same region and
+ * successive updates of a region are reduced to the last one, which keeps its place after any
+ * operation batched in between. On commit, each sharing cpu receives the resulting set in a single
+ * message.
+ */
+void mem_batch_begin(void);
+void mem_batch_commit(void);
 
 /**
  * This functions must be defined for the physical MPU. The abstraction provided by the physical
@@ -61,4 +78,11 @@ bool mpu_unmap(struct addr_space* as, struct mp_region* mem);
 bool mpu_update(struct addr_space* as, struct mp_region* mpr);
 bool mpu_perms_compatible(unsigned long perms1, unsigned long perms2);
 
+/**
+ * Optionally, the physical MPU layer may hold fewer regions than the vMPU and evict entries when
+ * it runs out. In that case, it must re-install a vMPU region which is not currently mapped when
+ * a fault hits it, returning true. The default implementation does not support this.
+ */
+bool mpu_demand_map(struct addr_space* as, struct mp_region* mpr);
+
 #endif /* __MEM_PROT_H__ */
@@ -0,0 +1,58 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#ifndef __VMPU_SORTED_H__
+#define __VMPU_SORTED_H__
+
+#include <mem_prot/mem.h>
+
+/**
+ * Index of the valid vMPU entries of an address space sorted by base address. Lookups binary
+ * search it instead of walking every entry.
+ */
+
+/* Returns the number of sorted entries whose base is lower or equal to addr */
+static inline size_t mem_vmpu_sorted_upper(struct addr_space* as, vaddr_t addr)
+{
+    size_t lo = 0;
+    size_t hi = as->vmpu.sorted_num;
+
+    while (lo < hi) {
+        size_t mid = lo + ((hi - lo) / 2);
+        if (as->vmpu.node[as->vmpu.sorted[mid]].region.base <= addr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+static inline void mem_vmpu_sorted_insert(struct addr_space* as, mpid_t mpid)
+{
+    size_t pos = mem_vmpu_sorted_upper(as, as->vmpu.node[mpid].region.base);
+
+    for (size_t i = as->vmpu.sorted_num; i > pos; i--) {
+        as->vmpu.sorted[i] = as->vmpu.sorted[i - 1];
+    }
+    as->vmpu.sorted[pos] = mpid;
+    as->vmpu.sorted_num++;
+}
+
+static inline void mem_vmpu_sorted_remove(struct addr_space* as, mpid_t mpid)
+{
+    for (size_t i = 0; i < as->vmpu.sorted_num; i++) {
+        if (as->vmpu.sorted[i] == mpid) {
+            as->vmpu.sorted_num--;
+            for (size_t j = i; j < as->vmpu.sorted_num; j++) {
+                as->vmpu.sorted[j] = as->vmpu.sorted[j + 1];
+            }
+            break;
+        }
+    }
+}
+
+#endif /* __VMPU_SORTED_H__ */
@@ -11,6 +11,7 @@
 #include <platform_defs.h>
 #include <objpool.h>
 #include <config.h>
+#include <mem_prot/vmpu_sorted.h>
 
 #define MEM_BROADCAST      (true)
 #define MEM_DONT_BROADCAST (false)
@@ -29,7 +30,7 @@ struct shared_region {
 void mem_handle_broadcast_region(uint32_t event, uint64_t data);
 bool mem_unmap_range(struct addr_space* as, vaddr_t vaddr, size_t size, bool broadcast);
 
-enum { MEM_INSERT_REGION, MEM_REMOVE_REGION, MEM_UPDATE_REGION };
+enum { MEM_INSERT_REGION, MEM_REMOVE_REGION, MEM_UPDATE_REGION, MEM_BATCH };
 
 #define SHARED_REGION_POOL_SIZE_DEFAULT (128)
 #ifndef SHARED_REGION_POOL_SIZE
@@ -37,6 +38,31 @@ enum { MEM_INSERT_REGION, MEM_REMOVE_REGION, MEM_UPDATE_REGION };
 #endif
 OBJPOOL_ALLOC(shared_region_pool, struct shared_region, SHARED_REGION_POOL_SIZE);
 
+#define MEM_BATCH_MAX_OPS_DEFAULT (16)
+#ifndef MEM_BATCH_MAX_OPS
+#define MEM_BATCH_MAX_OPS MEM_BATCH_MAX_OPS_DEFAULT
+#endif
+
+struct shared_region_batch {
+    size_t num;
+    struct shared_region_op {
+        uint32_t event;
+        struct shared_region shared_region;
+    } ops[MEM_BATCH_MAX_OPS];
+};
+
+#define SHARED_REGION_BATCH_POOL_SIZE_DEFAULT (2 * PLAT_CPU_NUM)
+#ifndef SHARED_REGION_BATCH_POOL_SIZE
+#define SHARED_REGION_BATCH_POOL_SIZE SHARED_REGION_BATCH_POOL_SIZE_DEFAULT
+#endif
+OBJPOOL_ALLOC(shared_region_batch_pool, struct shared_region_batch, SHARED_REGION_BATCH_POOL_SIZE);
+
+static struct mem_batch {
+    size_t depth;
+    cpumap_t cpus;
+    struct shared_region_batch batch;
+} mem_batch[PLAT_CPU_NUM];
+
 static inline struct mpe* mem_vmpu_get_entry(struct addr_space* as, mpid_t mpid)
 {
     if (mpid < VMPU_NUM_ENTRIES) {
@@ -73,6 +99,7 @@ static void mem_vmpu_set_entry(struct addr_space* as, mpid_t mpid, struct mp_reg
     mpe->lock = locked;
 
     list_insert_ordered(&as->vmpu.ordered_list, (node_t*)&as->vmpu.node[mpid], vmpu_node_cmp);
+    mem_vmpu_sorted_insert(as, mpid);
 }
 
 static void mem_vmpu_clear_entry(struct addr_space* as, mpid_t mpid)
@@ -89,6 +116,7 @@ static void mem_vmpu_clear_entry(struct addr_space* as, mpid_t mpid)
 
 static void mem_vmpu_free_entry(struct addr_space* as, mpid_t mpid)
 {
+    mem_vmpu_sorted_remove(as, mpid);
     mem_vmpu_clear_entry(as, mpid);
     struct mpe* mpe = mem_vmpu_get_entry(as, mpid);
     mpe->state = MPE_S_FREE;
@@ -127,18 +155,12 @@ static void mem_vmpu_deallocate_entry(struct addr_space* as, mpid_t mpid)
 static mpid_t mem_vmpu_get_entry_by_addr(struct addr_space* as, vaddr_t addr)
 {
     mpid_t mpid = INVALID_MPID;
+    size_t pos = mem_vmpu_sorted_upper(as, addr);
 
-    for (mpid_t i = 0; i < VMPU_NUM_ENTRIES; i++) {
-        struct mpe* mpe = mem_vmpu_get_entry(as, i);
-
-        if (mpe->state != MPE_S_VALID) {
-            continue;
-        }
-
-        vaddr_t limit_addr = mpe->region.base + mpe->region.size;
-        if ((addr >= mpe->region.base) && (addr < limit_addr)) {
-            mpid = i;
-            break;
+    if (pos > 0) {
+        struct mpe* mpe = mem_vmpu_get_entry(as, as->vmpu.sorted[pos - 1]);
+        if (addr < (mpe->region.base + mpe->region.size)) {
+            mpid = mpe->mpid;
         }
     }
 
@@ -258,6 +280,7 @@ void as_init(struct addr_space* as, enum AS_TYPE type, colormap_t colors)
     as_arch_init(as);
 
     list_init(&(as->vmpu.ordered_list));
+    as->vmpu.sorted_num = 0;
 
     for (size_t i = 0; i < VMPU_NUM_ENTRIES; i++) {
         mem_vmpu_free_entry(as, i);
@@ -305,6 +328,113 @@ static cpumap_t mem_section_shared_cpus(struct addr_space* as, as_sec_t section)
     return cpus;
 }
 
+static void mem_batch_flush(struct mem_batch* mb)
+{
+    for (cpuid_t cpuid = 0; cpuid < PLAT_CPU_NUM; cpuid++) {
+        if ((cpu()->id != cpuid) && bit_get(mb->cpus, cpuid)) {
+            struct shared_region_batch* node = objpool_alloc(&shared_region_batch_pool);
+            if (node == NULL) {
+                ERROR("Failed allocating shared region batch node\n");
+            }
+            node->num = mb->batch.num;
+            memcpy(node->ops, mb->batch.ops, mb->batch.num * sizeof(mb->batch.ops[0]));
+            struct cpu_msg msg = { (uint32_t)MEM_PROT_SYNC, MEM_BATCH, (uintptr_t)node };
+            cpu_send_msg(cpuid, &msg);
+        }
+    }
+
+    mb->batch.num = 0;
+    mb->cpus = 0;
+}
+
+static bool mem_batch_same_region(struct shared_region* r1, struct shared_region* r2)
+{
+    return (r1->as_type == r2->as_type) && (r1->asid == r2->asid) &&
+        (r1->region.base == r2->region.base);
+}
+
+static void mem_batch_drop(struct mem_batch* mb, size_t idx)
+{
+    mb->batch.num--;
+    for (size_t j = idx; j < mb->batch.num; j++) {
+        mb->batch.ops[j] = mb->batch.ops[j + 1];
+    }
+}
+
+/**
+ * Returns true if the operation was fully absorbed by the batch, or false if it still needs to be
+ * appended to it.
+ */
+static bool mem_batch_fold(struct mem_batch* mb, uint32_t op, struct shared_region* shared_region)
+{
+    for (size_t i = mb->batch.num; i > 0; i--) {
+        struct shared_region_op* prev = &mb->batch.ops[i - 1];
+        if (!mem_batch_same_region(&prev->shared_region, shared_region)) {
+            continue;
+        }
+
+        if (prev->shared_region.sharing_cpus != shared_region->sharing_cpus) {
+            break;
+        }
+
+        /**
+         * A region inserted and removed within the batch never needs to reach the other cpus, and
+         * consecutive updates to a region (e.g. successive coalescing steps) collapse into the
+         * last one. The last update replaces the earlier one at the end of the batch rather than in
+         * its place, so it is never applied before the removal of a region merged into it by an
+         * intermediate step. For the same reason, updates are not folded into insertions.
+         */
+        if (prev->event == MEM_INSERT_REGION && op == MEM_REMOVE_REGION &&
+            prev->shared_region.region.size == shared_region->region.size) {
+            mem_batch_drop(mb, i - 1);
+            return true;
+        } else if (prev->event == MEM_UPDATE_REGION && op == MEM_UPDATE_REGION) {
+            mem_batch_drop(mb, i - 1);
+            return false;
+        }
+
+        break;
+    }
+
+    return false;
+}
+
+static void mem_batch_add(uint32_t op, struct shared_region* shared_region)
+{
+    struct mem_batch* mb = &mem_batch[cpu()->id];
+
+    if (mem_batch_fold(mb, op, shared_region)) {
+        return;
+    }
+
+    if (mb->batch.num >= MEM_BATCH_MAX_OPS) {
+        mem_batch_flush(mb);
+    }
+
+    mb->batch.ops[mb->batch.num].event = op;
+    mb->batch.ops[mb->batch.num].shared_region = *shared_region;
+    mb->batch.num++;
+    mb->cpus |= shared_region->sharing_cpus;
+}
+
+void mem_batch_begin(void)
+{
+    mem_batch[cpu()->id].depth++;
+}
+
+void mem_batch_commit(void)
+{
+    struct mem_batch* mb = &mem_batch[cpu()->id];
+
+    if (mb->depth > 0) {
+        mb->depth--;
+    }
+
+    if ((mb->depth == 0) && (mb->batch.num > 0)) {
+        mem_batch_flush(mb);
+    }
+}
+
 static void mem_region_broadcast(struct addr_space* as, struct mp_region* mpr, uint32_t op,
     bool locked)
 {
@@ -318,9 +448,15 @@ static void mem_region_broadcast(struct addr_space* as, struct mp_region* mpr, u
         .as_type = as->type,
         .asid = as->id,
         .region = *mpr,
+        .sharing_cpus = shared_cpus,
         .lock = locked,
     };
 
+    if (mem_batch[cpu()->id].depth > 0) {
+        mem_batch_add(op, &shared_region);
+        return;
+    }
+
     for (cpuid_t cpuid = 0; cpuid < PLAT_CPU_NUM; cpuid++) {
         if ((cpu()->id != cpuid) && bit_get(shared_cpus, cpuid)) {
             struct shared_region* node = objpool_alloc(&shared_region_pool);
@@ -433,10 +569,11 @@ static void mem_handle_broadcast_remove(struct addr_space* as, struct mp_region*
 static bool mem_update(struct addr_space* as, struct mp_region* mpr, bool broadcast, bool locked)
 {
     mpid_t update_mpid = INVALID_MPID;
-    list_foreach (as->vmpu.ordered_list, struct mpe, cur) {
+    size_t pos = mem_vmpu_sorted_upper(as, mpr->base);
+    if (pos > 0) {
+        struct mpe* cur = mem_vmpu_get_entry(as, as->vmpu.sorted[pos - 1]);
         if (cur->region.base == mpr->base && cur->region.size != mpr->size) {
             update_mpid = cur->mpid;
-            break;
         }
     }
     if (update_mpid != INVALID_MPID) {
@@ -454,37 +591,53 @@ static void mem_handle_broadcast_update(struct addr_space* as, struct mp_region*
     }
 }
 
-void mem_handle_broadcast_region(uint32_t event, uint64_t data)
+static void mem_handle_shared_region(uint32_t event, struct shared_region* sh_reg)
 {
-    struct shared_region* sh_reg = (struct shared_region*)(uintptr_t)data;
+    struct addr_space* as;
+    if (sh_reg->as_type == AS_HYP) {
+        as = &cpu()->as;
+    } else {
+        struct addr_space* vm_as = &cpu()->vcpu->vm->as;
+        if (vm_as->id != sh_reg->asid) {
+            ERROR("Received shared region for unknown vm address space.\n");
+        }
+        as = vm_as;
+    }
 
-    if (sh_reg != NULL) {
-        struct addr_space* as;
-        if (sh_reg->as_type == AS_HYP) {
-            as = &cpu()->as;
-        } else {
-            struct addr_space* vm_as = &cpu()->vcpu->vm->as;
-            if (vm_as->id != sh_reg->asid) {
-                ERROR("Received shared region for unknown vm address space.\n");
+    switch (event) {
+        case MEM_INSERT_REGION:
+            mem_handle_broadcast_insert(as, &sh_reg->region, sh_reg->lock);
+            break;
+        case MEM_REMOVE_REGION:
+            mem_handle_broadcast_remove(as, &sh_reg->region);
+            break;
+        case MEM_UPDATE_REGION:
+            mem_handle_broadcast_update(as, &sh_reg->region, sh_reg->lock);
+            break;
+        default:
+            ERROR("unknown mem broadcast msg\n");
+    }
+}
+
+void mem_handle_broadcast_region(uint32_t event, uint64_t data)
+{
+    if (event == MEM_BATCH) {
+        struct shared_region_batch* batch = (struct shared_region_batch*)(uintptr_t)data;
+        if (batch != NULL) {
+            for (size_t i = 0; i < batch->num; i++) {
+                struct shared_region* sh_reg = &batch->ops[i].shared_region;
+                if (bit_get(sh_reg->sharing_cpus, cpu()->id)) {
+                    mem_handle_shared_region(batch->ops[i].event, sh_reg);
+                }
             }
-            as = vm_as;
+            objpool_free(&shared_region_batch_pool, batch);
         }
-
-        switch (event) {
-            case MEM_INSERT_REGION:
-                mem_handle_broadcast_insert(as, &sh_reg->region, sh_reg->lock);
-                break;
-            case MEM_REMOVE_REGION:
-                mem_handle_broadcast_remove(as, &sh_reg->region);
-                break;
-            case MEM_UPDATE_REGION:
-                mem_handle_broadcast_update(as, &sh_reg->region, sh_reg->lock);
-                break;
-            default:
-                ERROR("unknown mem broadcast msg\n");
+    } else {
+        struct shared_region* sh_reg = (struct shared_region*)(uintptr_t)data;
+        if (sh_reg != NULL) {
+            mem_handle_shared_region(event, sh_reg);
+            objpool_free(&shared_region_pool, sh_reg);
         }
-
-        objpool_free(&shared_region_pool, sh_reg);
     }
 }
 
@@ -492,15 +645,16 @@ static mpid_t mem_vmpu_find_overlapping_region(struct addr_space* as, struct mp_
 {
     mpid_t mpid = INVALID_MPID;
 
-    for (mpid_t i = 0; i < VMPU_NUM_ENTRIES; i++) {
-        struct mpe* mpe = mem_vmpu_get_entry(as, i);
-
-        if (mpe->state != MPE_S_VALID) {
-            continue;
-        }
-
+    /**
+     * Valid regions do not overlap each other, so only two of them can overlap the given region
+     * without also overlapping a region between them: the one with the highest base not above the
+     * region's base and the one following it.
+     */
+    size_t pos = mem_vmpu_sorted_upper(as, region->base);
+    for (size_t i = (pos > 0) ? pos - 1 : pos; i < min(pos + 1, as->vmpu.sorted_num); i++) {
+        struct mpe* mpe = mem_vmpu_get_entry(as, as->vmpu.sorted[i]);
         if (mem_regions_overlap(region, &mpe->region)) {
-            mpid = i;
+            mpid = mpe->mpid;
             break;
         }
     }
@@ -571,8 +725,9 @@ bool mem_map(struct addr_space* as, struct mp_region* mpr, bool broadcast, bool
         mpid = mem_vmpu_allocate_entry(as);
         if (mpid != INVALID_MPID) {
             mapped = mem_vmpu_insert_region(as, mpid, mpr, broadcast, locked);
-        } else {
-            mem_vmpu_deallocate_entry(as, mpid);
+            if (!mapped) {
+                mem_vmpu_deallocate_entry(as, mpid);
+            }
         }
     }
 
@@ -585,6 +740,28 @@ bool mem_map(struct addr_space* as, struct mp_region* mpr, bool broadcast, bool
     return mapped;
 }
 
+__attribute__((weak)) bool mpu_demand_map(struct addr_space* as, struct mp_region* mpr)
+{
+    UNUSED_ARG(as);
+    UNUSED_ARG(mpr);
+
+    return false;
+}
+
+bool mem_demand_map(struct addr_space* as, vaddr_t addr)
+{
+    bool mapped = false;
+
+    spin_lock(&as->lock);
+    mpid_t mpid = mem_vmpu_get_entry_by_addr(as, addr);
+    if (mpid != INVALID_MPID) {
+        mapped = mpu_demand_map(as, &mem_vmpu_get_entry(as, mpid)->region);
+    }
+    spin_unlock(&as->lock);
+
+    return mapped;
+}
+
 bool mem_unmap_range(struct addr_space* as, vaddr_t vaddr, size_t size, bool broadcast)
 {
     spin_lock(&as->lock);
@@ -15,3 +15,16 @@ void vm_mem_prot_init(struct vm* vm, const struct vm_config* config)
         mem_mmio_init_regions(&vm->as);
     }
 }
+
+void vm_mem_prot_add_dev(struct vm* vm, struct vm_dev_region* dev)
+{
+    if (DEFINED(MMIO_SLAVE_SIDE_PROT)) {
+        /* The platform MMIO windows are already mapped in the VM address space
+        by vm_mem_prot_init, so no MPU entry is spent per device. Isolation is
+        left to the bus-side protection units guarding each peripheral. */
+        vm_arch_allow_mmio_access(vm, dev);
+    } else if (dev->va != INVALID_VA) {
+        size_t n = ALIGN(dev->size, PAGE_SIZE) / PAGE_SIZE;
+        mem_alloc_map_dev(&vm->as, SEC_VM_ANY, (vaddr_t)dev->va, dev->pa, n);
+    }
+}
@@ -3,6 +3,7 @@
 
 core-objs-y+=init.o
 core-objs-y+=mem.o
+core-objs-y+=page_pool.o
 core-objs-y+=cache.o
 core-objs-y+=interrupts.o
 core-objs-y+=cpu.o
@@ -0,0 +1,78 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#include <page_pool.h>
+
+bool pp_alloc(struct page_pool* pool, size_t num_pages, bool aligned, struct ppages* ppages)
+{
+    ppages->colors = 0;
+    ppages->num_pages = 0;
+
+    bool ok = false;
+
+    if (num_pages == 0) {
+        return true;
+    }
+
+    spin_lock(&pool->lock);
+
+    /**
+     * If we need a contigous segment aligned to its size, lets start at an already aligned index.
+     */
+    size_t start;
+    size_t curr;
+    if (aligned) {
+        start = pool->base / PAGE_SIZE % num_pages;
+        curr = pool->last + ((num_pages - ((pool->last + start) % num_pages)) % num_pages);
+    } else {
+        start = 0;
+        curr = pool->last;
+    }
+
+    /**
+     * Lets make two searches:
+     *  - one starting from the last known free index.
+     *  - in case this does not work, start from index 0.
+     */
+    for (size_t i = 0; i < 2 && !ok; i++) {
+        while (pool->free != 0) {
+            ssize_t bit =
+                bitmap_find_consec(pool->bitmap, pool->num_pages, curr, num_pages, BITMAP_NOT_SET);
+
+            if (bit < 0) {
+                /**
+                 * No num_page page sement was found. If this is the first iteration set position
+                 * to 0 to start next search from index
+                 * 0.
+                 */
+                size_t next_aligned =
+                    (num_pages - ((pool->base / PAGE_SIZE) % num_pages)) % num_pages;
+                curr = aligned ? next_aligned : 0;
+                break;
+            } else if (aligned && (((((size_t)bit) + start) % num_pages) != 0)) {
+                /**
+                 * If we're looking for an aligned segment and the found contigous segment is not
+                 * aligned, start the search again from the last aligned index
+                 */
+                curr = ((size_t)bit) + (num_pages - ((((size_t)bit) + start) % num_pages));
+            } else {
+                /**
+                 * We've found our pages. Fill output argument info, mark them as allocated, and
+                 * update page pool bookkeeping.
+                 */
+                ppages->base = pool->base + (((size_t)bit) * PAGE_SIZE);
+                ppages->num_pages = num_pages;
+                bitmap_set_consecutive(pool->bitmap, ((size_t)bit), num_pages);
+                pool->free -= num_pages;
+                pool->last = ((size_t)bit) + num_pages;
+                ok = true;
+                break;
+            }
+        }
+    }
+    spin_unlock(&pool->lock);
+
+    return ok;
+}
@@ -15,11 +15,29 @@
 #include <objpool.h>
 #include <config.h>
 #include <spinlock.h>
+#include <interrupts.h>
 
 #define REMIO_VCPU_NUM             PLAT_CPU_NUM
 #define REMIO_NUM_DEV_TYPES        (REMIO_DEV_BACKEND - REMIO_DEV_FRONTEND + 1)
 #define REMIO_NEXT_PENDING_REQUEST -1
 
+/**
+ * Bounds, in poll iterations, of the adaptive window during which a frontend CPU spins waiting for
+ * the backend to complete an I/O request before entering standby. Defining REMIO_POLL_WINDOW_MAX
+ * as 0 (e.g., -DREMIO_POLL_WINDOW_MAX=0) disables polling altogether.
+ */
+#ifndef REMIO_POLL_WINDOW_MAX
+#define REMIO_POLL_WINDOW_MAX (0x4000)
+#endif
+#define REMIO_POLL_WINDOW_MIN  (min(0x40, REMIO_POLL_WINDOW_MAX))
+#define REMIO_POLL_WINDOW_INIT (REMIO_POLL_WINDOW_MAX / 4)
+
+/**
+ * Number of consecutive poll misses at the minimum window after which a request is polled with
+ * the maximum window, so that a backend that became faster is eventually detected again.
+ */
+#define REMIO_POLL_PROBE_PERIOD (64)
+
 /**
  * @enum REMIO_HYP_EVENT
  * @brief This enum represents the Remote I/O hypercall events
@@ -108,6 +126,19 @@ struct remio_device_config {
     } frontend;
 };
 
+/**
+ * @struct remio_poll
+ * @brief This structure holds the adaptive polling state of a Remote I/O device
+ * @note The fields are updated without locking by the frontend CPUs. Lost updates only affect
+ *       the heuristic, never the correctness of the I/O request handling.
+ */
+struct remio_poll {
+    size_t window; /**< Current polling window (in poll iterations) */
+    size_t misses; /**< Consecutive misses while at the minimum window */
+    size_t hits;   /**< Number of requests completed while polling */
+    size_t stalls; /**< Number of requests that required the frontend CPU to enter standby */
+};
+
 /**
  * @struct remio_device
  * @brief This structure comprises all the information needed about a Remote I/O device
@@ -118,6 +149,7 @@ struct remio_device {
     remio_bind_key_t bind_key;         /**< Remote I/O bind key */
     struct remio_device_config config; /**< Remote I/O device configuration */
     struct list pending_requests_list; /**< List of pending I/O requests */
+    struct remio_poll poll;            /**< Frontend adaptive polling state */
 };
 
 /** List of Remote I/O devices */
@@ -144,14 +176,15 @@ OBJPOOL_ALLOC(remio_request_pool, struct remio_request, REMIO_VCPU_NUM);
  * @brief Creates a new Remote I/O request based on the MMIO access information
  * @param device Pointer to the Remote I/O device
  * @param acc Pointer to the emul_access structure containing the MMIO access information
- * @return Returns true if the operation was successful, false otherwise
+ * @return Returns the created Remote I/O request or NULL if the operation failed
  */
-static bool remio_create_request(struct remio_device* device, struct emul_access* acc)
+static struct remio_request* remio_create_request(struct remio_device* device,
+    struct emul_access* acc)
 {
     objpool_id_t id;
     struct remio_request* request = objpool_alloc_with_id(&remio_request_pool, &id);
     if (request == NULL) {
-        return false;
+        return NULL;
     }
 
     request->id = id;
@@ -173,7 +206,7 @@ static bool remio_create_request(struct remio_device* device, struct emul_access
 
     list_push(&device->pending_requests_list, (node_t*)request);
 
-    return true;
+    return request;
 }
 
 /**
@@ -346,6 +379,10 @@ void remio_init(void)
                 }
                 device->ready = false;
                 device->bind_key = dev->bind_key;
+                device->poll.window = REMIO_POLL_WINDOW_INIT;
+                device->poll.misses = 0;
+                device->poll.hits = 0;
+                device->poll.stalls = 0;
                 device->config.backend.bind_key = (remio_bind_key_t)-1;
                 device->config.frontend.bind_key = (remio_bind_key_t)-1;
                 list_init(&device->pending_requests_list);
@@ -577,9 +614,75 @@ long int remio_hypercall(void)
     return ret;
 }
 
+HYPERCALL_HANDLER(remio_hypercall, HC_REMIO)
+
+/**
+ * @brief Updates the polling window of a Remote I/O device based on the outcome of a poll
+ * @param device Pointer to the Remote I/O device
+ * @param completed True if the request completed while polling, false otherwise
+ * @param spins Number of poll iterations performed
+ */
+static void remio_poll_update_window(struct remio_device* device, bool completed, size_t spins)
+{
+    struct remio_poll* poll = &device->poll;
+
+    if (completed) {
+        /** Track the observed completion latency with a 2x margin */
+        poll->window = min(max(spins * 2, REMIO_POLL_WINDOW_MIN), REMIO_POLL_WINDOW_MAX);
+        poll->misses = 0;
+        poll->hits++;
+    } else {
+        /** The backend is slower than the window, spinning longer would only waste cycles */
+        if (poll->window > REMIO_POLL_WINDOW_MIN) {
+            poll->window = max(poll->window / 2, REMIO_POLL_WINDOW_MIN);
+        } else if (++poll->misses >= REMIO_POLL_PROBE_PERIOD) {
+            poll->window = REMIO_POLL_WINDOW_MAX;
+            poll->misses = 0;
+        }
+        poll->stalls++;
+    }
+}
+
+/**
+ * @brief Polls for the completion of the current vCPU's I/O request before entering standby
+ * @note The backend signals the completion of the I/O request through a CPU message. If it
+ *       arrives within the polling window, it is handled right away, reactivating the vCPU and
+ *       avoiding the standby entry and wake up round trip. The IPI is cleared before handling the
+ *       messages so that any message queued afterwards still raises a new one.
+ * @param device Pointer to the Remote I/O device
+ * @param request Pointer to the Remote I/O request
+ */
+static void remio_poll_completion(struct remio_device* device, struct remio_request* request)
+{
+    struct vcpu* vcpu = cpu()->vcpu;
+    volatile enum REMIO_STATE* state = &request->state;
+    size_t window = device->poll.window;
+    size_t spins = 0;
+
+    if (window == 0) {
+        return;
+    }
+
+    while (spins < window && *state != REMIO_STATE_COMPLETE) {
+        spins++;
+    }
+
+    while (*state == REMIO_STATE_COMPLETE && circular_queue_is_empty(&cpu()->interface->msgs)) { }
+
+    if (!circular_queue_is_empty(&cpu()->interface->msgs)) {
+        if (interrupts_ipi_check()) {
+            interrupts_ipi_clear();
+        }
+        cpu_msg_handler();
+    }
+
+    remio_poll_update_window(device, vcpu->active, spins);
+}
+
 bool remio_mmio_emul_handler(struct emul_access* acc)
 {
     struct remio_device* device = NULL;
+    struct remio_request* request = NULL;
 
     /** Find the Remote I/O device based on the MMIO access address */
     device = remio_find_vm_dev_by_addr(cpu()->vcpu->vm, acc->addr);
@@ -592,7 +695,8 @@ bool remio_mmio_emul_handler(struct emul_access* acc)
         ;
 
     /** Create a new Remote I/O request based on the MMIO access information */
-    if (!remio_create_request(device, acc)) {
+    request = remio_create_request(device, acc);
+    if (request == NULL) {
         return false;
     }
 
@@ -603,6 +707,9 @@ bool remio_mmio_emul_handler(struct emul_access* acc)
     /** Pause the current vCPU to wait for the MMIO emulation to be completed */
     cpu()->vcpu->active = false;
 
+    /** Spin for a while before standby as fast backends might complete the request right away */
+    remio_poll_completion(device, request);
+
     return true;
 }
 
@@ -42,6 +42,9 @@ void shmem_init()
         for (size_t i = 0; i < config.shmemlist_size; i++) {
             shmem_table[i].lock = SPINLOCK_INITVAL;
             shmem_table[i].cpu_masters = 0;
+            for (size_t j = 0; j < CONFIG_VM_NUM; j++) {
+                shmem_table[i].ipcs[j] = NULL;
+            }
         }
 
         shmem_alloc();
@@ -194,6 +194,8 @@ static void vm_init_ipc(struct vm* vm, const struct vm_config* vm_config)
         shmem->cpu_masters |= (1UL << cpu()->id);
         spin_unlock(&shmem->lock);
 
+        ipc_vm_register(vm, ipc, shmem);
+
         struct vm_mem_region reg = {
             .base = ipc->base,
             .size = size,
@@ -211,12 +213,7 @@ static void vm_init_dev(struct vm* vm, const struct vm_config* vm_config)
     for (size_t i = 0; i < vm_config->platform.dev_num; i++) {
         struct vm_dev_region* dev = &vm_config->platform.devs[i];
 
-        if (DEFINED(MMIO_SLAVE_SIDE_PROT)) {
-            vm_arch_allow_mmio_access(vm, dev);
-        } else if (dev->va != INVALID_VA) {
-            size_t n = ALIGN(dev->size, PAGE_SIZE) / PAGE_SIZE;
-            mem_alloc_map_dev(&vm->as, SEC_VM_ANY, (vaddr_t)dev->va, dev->pa, n);
-        }
+        vm_mem_prot_add_dev(vm, dev);
 
         for (size_t j = 0; j < dev->interrupt_num; j++) {
             if (!interrupts_vm_assign(vm, dev->interrupts[j])) {
@@ -339,10 +336,12 @@ struct vm* vm_init(struct vm_allocation* vm_alloc, struct cpu_synctoken* vm_init
      * Create the VM's address space according to configuration and where its image was loaded.
      */
     if (master) {
+        mem_batch_begin();
         vm_init_mem_regions(vm, vm_config);
         vm_init_dev(vm, vm_config);
         vm_init_ipc(vm, vm_config);
         vm_init_remio(vm, vm_config);
+        mem_batch_commit();
     }
 
     cpu_sync_and_clear_msgs(&vm->sync);
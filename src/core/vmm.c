@@ -11,6 +11,7 @@
 #include <fences.h>
 #include <string.h>
 #include <shmem.h>
+#include <hypercall.h>
 
 static struct vm_assignment {
     spinlock_t lock;
@@ -129,7 +130,9 @@ void vmm_init()
     vmm_arch_init();
     vmm_io_init();
     shmem_init();
+    ipc_init();
     remio_init();
+    hypercall_init();
 
     if (cpu_is_master()) {
         for (size_t i = 0; i < CONFIG_VM_NUM; i++) {
@@ -30,15 +30,24 @@ size_t bitmap_count_consecutive(bitmap_t* map, size_t size, size_t start, size_t
     size_t pos = start;
     size_t count = 0;
     size_t start_offset = start % BITMAP_GRANULE_LEN;
-    size_t first_word_bits = min(BITMAP_GRANULE_LEN - start_offset, n);
-    bool set = !!bitmap_get(map, start);
-    bitmap_granule_t init_mask = BITMAP_GRANULE_MASK(start_offset, first_word_bits);
+    size_t first_word_bits;
+    bool set;
+    bitmap_granule_t init_mask;
     bitmap_granule_t mask;
 
     if (n <= 1) {
         return n;
     }
 
+    if (start >= size) {
+        return 0;
+    }
+
+    /* Never look past the end of the map, even if the last granule has room for more bits */
+    first_word_bits = min(BITMAP_GRANULE_LEN - start_offset, min(n, size - start));
+    set = !!bitmap_get(map, start);
+    init_mask = BITMAP_GRANULE_MASK(start_offset, first_word_bits);
+
     mask = set ? init_mask : ~init_mask;
     if (!((map[pos / BITMAP_GRANULE_LEN] ^ mask) & init_mask)) {
         count += first_word_bits;
@@ -46,7 +55,8 @@ size_t bitmap_count_consecutive(bitmap_t* map, size_t size, size_t start, size_t
     }
 
     mask = set ? ~0U : 0U;
-    while ((pos < size) && !(map[pos / BITMAP_GRANULE_LEN] ^ mask) && (count < n)) {
+    while (((pos + BITMAP_GRANULE_LEN) <= size) && !(map[pos / BITMAP_GRANULE_LEN] ^ mask) &&
+        (count < n)) {
         count += BITMAP_GRANULE_LEN;
         pos += BITMAP_GRANULE_LEN;
     }
@@ -56,7 +66,7 @@ size_t bitmap_count_consecutive(bitmap_t* map, size_t size, size_t start, size_t
         pos += 1;
     }
 
-    return count;
+    return min(count, n);
 }
 
 ssize_t bitmap_find_consec(bitmap_t* map, size_t size, size_t start, size_t n, bool set)
@@ -95,6 +105,11 @@ void bitmap_set_consecutive(bitmap_t* map, size_t start, size_t n)
     size_t start_offset = start % BITMAP_GRANULE_LEN;
     size_t first_word_bits = min(BITMAP_GRANULE_LEN - start_offset, count);
 
+    /* BITMAP_GRANULE_MASK is not defined for a zero length */
+    if (n == 0) {
+        return;
+    }
+
     map[pos / BITMAP_GRANULE_LEN] |= BITMAP_GRANULE_MASK(start_offset, first_word_bits);
     pos += first_word_bits;
     count -= first_word_bits;
@@ -58,9 +58,11 @@ static size_t vprintd(char** buf, unsigned int flags, va_list* args)
         if (s < 0) {
             printc(buf, '-');
             char_count++;
-            s = -s;
+            /* Negate as unsigned so the most negative value does not overflow */
+            u = 0UL - (unsigned long)s;
+        } else {
+            u = (unsigned long)s;
         }
-        u = (unsigned long)s;
     }
 
     divisor = 1;
@@ -145,7 +147,7 @@ size_t vsnprintk(char* buf, size_t buf_size, const char** fmt, va_list* args)
                     case 'c':
                         arg_char_count = 1;
                         if (arg_char_count <= buf_left) {
-                            printc(&buf_it, (char)va_arg(args_tmp, int));
+                            printc(&buf_it, (char)va_arg(*args, int));
                         }
                         break;
                     case '%':
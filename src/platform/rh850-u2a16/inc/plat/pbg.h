@@ -10,7 +10,9 @@
 
 #define PLAT_NUM_PBG_CHANNELS (16)
 
-#define PLAT_PBG_BASE         (0xFF0A1300UL)
+#ifndef PLAT_PBG_BASE
+#define PLAT_PBG_BASE (0xFF0A1300UL)
+#endif
 
 #define PBGKCPROT_ENABLE_WR   (0xA5A5A501UL)
 #define PBGKCPROT_DISABLE_WR  (0xA5A5A500UL)
@@ -102,5 +104,10 @@ struct pbg_hw {
 };
 
 void pbg_init(void);
+/**
+ * Grants @spid access through the guard channels the platform lists for the device at @dev_base.
+ * Returns false if the platform does not describe the device.
+ */
+bool pbg_allow_device(paddr_t dev_base, unsigned long spid);
 
 #endif /* __PLAT_PBG_H__ */
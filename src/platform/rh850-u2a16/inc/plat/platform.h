@@ -15,6 +15,12 @@
 #include <plat/pbg.h>
 #endif /* __ASSEMBLER__ */
 
+/* The P-Bus guard channels and MMIO windows of the U2A16 peripherals are not described, so VM
+devices can not be isolated on the bus side */
+#ifdef MMIO_SLAVE_SIDE_PROT
+#error "Slave side protection requires the P-Bus guard device table of the platform."
+#endif
+
 /* Interrupts */
 #define PLAT_MAX_INTERRUPTS      768
 
@@ -4,28 +4,52 @@
  */
 
 #include <platform.h>
+#include <spinlock.h>
+#include <arch/vmm.h>
 
-#define PBGPROT1_SPID_MASK (((1UL << 16) - 1) | (1UL << 16))
+#define PBGPROT1_SPID(spid) (1UL << (spid))
+#define PBGPROT1_SPID_MASK  (((1UL << 16) - 1) | (1UL << 16))
 
 volatile struct pbg_hw* pbg;
 
+/* PBGKCPROT is shared by all guards, so unlocking and relocking it must not interleave */
+static spinlock_t pbg_lock = SPINLOCK_INITVAL;
+
+static void pbg_set_write_key(unsigned long key)
+{
+    pbg->PBGERRSLV00.PBGKCPROT = key;
+    pbg->PBGERRSLV10.PBGKCPROT = key;
+    pbg->PBGERRSLV20.PBGKCPROT = key;
+    pbg->PBGERRSLV30.PBGKCPROT = key;
+    pbg->PBGERRSLV40.PBGKCPROT = key;
+    pbg->PBGERRSLV50.PBGKCPROT = key;
+    pbg->PBGERRSLV6L0.PBGKCPROT = key;
+    pbg->PBGERRSLV6L1.PBGKCPROT = key;
+    pbg->PBGERRSLV6H0.PBGKCPROT = key;
+    pbg->PBGERRSLV70.PBGKCPROT = key;
+    pbg->PBGERRSLV80.PBGKCPROT = key;
+    pbg->PBGERRSLV90.PBGKCPROT = key;
+}
+
+static const struct plat_device* pbg_find_device(paddr_t dev_base)
+{
+    const struct plat_device* ret = NULL;
+
+    for (unsigned long i = 0; i < platform.arch.device_num; i++) {
+        if (platform.arch.devices[i].dev_base == dev_base) {
+            ret = &platform.arch.devices[i];
+            break;
+        }
+    }
+    return ret;
+}
+
 void pbg_init(void)
 {
     pbg = (struct pbg_hw*)PLAT_PBG_BASE;
 
     /* Enable write to PBGPROT registers */
-    pbg->PBGERRSLV00.PBGKCPROT = PBGKCPROT_ENABLE_WR;
-    pbg->PBGERRSLV10.PBGKCPROT = PBGKCPROT_ENABLE_WR;
-    pbg->PBGERRSLV20.PBGKCPROT = PBGKCPROT_ENABLE_WR;
-    pbg->PBGERRSLV30.PBGKCPROT = PBGKCPROT_ENABLE_WR;
-    pbg->PBGERRSLV40.PBGKCPROT = PBGKCPROT_ENABLE_WR;
-    pbg->PBGERRSLV50.PBGKCPROT = PBGKCPROT_ENABLE_WR;
-    pbg->PBGERRSLV6L0.PBGKCPROT = PBGKCPROT_ENABLE_WR;
-    pbg->PBGERRSLV6L1.PBGKCPROT = PBGKCPROT_ENABLE_WR;
-    pbg->PBGERRSLV6H0.PBGKCPROT = PBGKCPROT_ENABLE_WR;
-    pbg->PBGERRSLV70.PBGKCPROT = PBGKCPROT_ENABLE_WR;
-    pbg->PBGERRSLV80.PBGKCPROT = PBGKCPROT_ENABLE_WR;
-    pbg->PBGERRSLV90.PBGKCPROT = PBGKCPROT_ENABLE_WR;
+    pbg_set_write_key(PBGKCPROT_ENABLE_WR);
 
     /* Allow SPIDs [0-16] to write to P-Bus */
     for (size_t i = 0; i < PLAT_NUM_PBG_CHANNELS; i++) {
@@ -52,17 +76,37 @@ void pbg_init(void)
         pbg->PBG90.ch[i].PBGPROT1 |= (PBGPROT1_SPID_MASK);
     }
 
+    /* With slave side protection, the guard channels of the devices described by the platform are
+    restricted to the hypervisor and VMs are then allowed on the channels of their devices. Devices
+    the platform does not describe remain accessible to every SPID. */
+    if (DEFINED(MMIO_SLAVE_SIDE_PROT)) {
+        for (unsigned long i = 0; i < platform.arch.device_num; i++) {
+            const struct plat_device* pdev = &platform.arch.devices[i];
+            for (unsigned long j = 0; j < pdev->pbg_num; j++) {
+                *(volatile uint32_t*)pdev->pbg_prot[j] = (uint32_t)PBGPROT1_SPID(HYP_SPID);
+            }
+        }
+    }
+
     /* Disable write to PBGPROT registers */
-    pbg->PBGERRSLV00.PBGKCPROT = PBGKCPROT_DISABLE_WR;
-    pbg->PBGERRSLV10.PBGKCPROT = PBGKCPROT_DISABLE_WR;
-    pbg->PBGERRSLV20.PBGKCPROT = PBGKCPROT_DISABLE_WR;
-    pbg->PBGERRSLV30.PBGKCPROT = PBGKCPROT_DISABLE_WR;
-    pbg->PBGERRSLV40.PBGKCPROT = PBGKCPROT_DISABLE_WR;
-    pbg->PBGERRSLV50.PBGKCPROT = PBGKCPROT_DISABLE_WR;
-    pbg->PBGERRSLV6L0.PBGKCPROT = PBGKCPROT_DISABLE_WR;
-    pbg->PBGERRSLV6L1.PBGKCPROT = PBGKCPROT_DISABLE_WR;
-    pbg->PBGERRSLV6H0.PBGKCPROT = PBGKCPROT_DISABLE_WR;
-    pbg->PBGERRSLV70.PBGKCPROT = PBGKCPROT_DISABLE_WR;
-    pbg->PBGERRSLV80.PBGKCPROT = PBGKCPROT_DISABLE_WR;
-    pbg->PBGERRSLV90.PBGKCPROT = PBGKCPROT_DISABLE_WR;
+    pbg_set_write_key(PBGKCPROT_DISABLE_WR);
+}
+
+bool pbg_allow_device(paddr_t dev_base, unsigned long spid)
+{
+    const struct plat_device* pdev = pbg_find_device(dev_base);
+
+    if (pdev == NULL) {
+        return false;
+    }
+
+    spin_lock(&pbg_lock);
+    pbg_set_write_key(PBGKCPROT_ENABLE_WR);
+    for (unsigned long i = 0; i < pdev->pbg_num; i++) {
+        *(volatile uint32_t*)pdev->pbg_prot[i] |= (uint32_t)PBGPROT1_SPID(spid);
+    }
+    pbg_set_write_key(PBGKCPROT_DISABLE_WR);
+    spin_unlock(&pbg_lock);
+
+    return true;
 }
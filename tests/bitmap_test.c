@@ -0,0 +1,152 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#include <test.h>
+#include <bitmap.h>
+
+#define NBITS (1000)
+
+static BITMAP_ALLOC(map, NBITS);
+static bool ref[NBITS];
+
+static ssize_t ref_find_nth(size_t nth, size_t start, bool set)
+{
+    size_t count = 0;
+    for (size_t i = start; i < NBITS; i++) {
+        if (ref[i] == set && ++count == nth) {
+            return (ssize_t)i;
+        }
+    }
+    return -1;
+}
+
+static size_t ref_count_consecutive(size_t start, size_t n)
+{
+    size_t count = 0;
+    for (size_t i = start; i < NBITS && count < n && ref[i] == ref[start]; i++) {
+        count++;
+    }
+    return count;
+}
+
+static ssize_t ref_find_consec(size_t start, size_t n, bool set)
+{
+    for (size_t i = start; i + n <= NBITS; i++) {
+        size_t j = 0;
+        while (j < n && ref[i + j] == set) {
+            j++;
+        }
+        if (j == n) {
+            return (ssize_t)i;
+        }
+    }
+    return -1;
+}
+
+static void check_all(void)
+{
+    for (size_t i = 0; i < NBITS; i++) {
+        TEST_ASSERT(bitmap_get(map, i) == ref[i]);
+    }
+}
+
+static void random_update(void)
+{
+    size_t start = test_rand_range(NBITS);
+    size_t n = test_rand_range(NBITS - start) % 80;
+
+    switch (test_rand_range(4)) {
+        case 0:
+            bitmap_set(map, start);
+            ref[start] = true;
+            break;
+        case 1:
+            bitmap_clear(map, start);
+            ref[start] = false;
+            break;
+        case 2:
+            bitmap_set_consecutive(map, start, n);
+            for (size_t i = 0; i < n; i++) {
+                ref[start + i] = true;
+            }
+            break;
+        default:
+            bitmap_clear_consecutive(map, start, n);
+            for (size_t i = 0; i < n; i++) {
+                ref[start + i] = false;
+            }
+            break;
+    }
+}
+
+void test_run(void)
+{
+    for (unsigned long it = 0; it < TEST_ITERATIONS; it++) {
+        random_update();
+
+        size_t start = test_rand_range(NBITS);
+        size_t nth = 1 + test_rand_range(8);
+        size_t n = 1 + test_rand_range(24);
+        bool set = test_rand_range(2);
+
+        TEST_ASSERT(
+            bitmap_find_nth(map, NBITS, nth, start, set) == ref_find_nth(nth, start, set));
+        TEST_ASSERT(
+            bitmap_count_consecutive(map, NBITS, start, n) == ref_count_consecutive(start, n));
+        TEST_ASSERT(
+            bitmap_find_consec(map, NBITS, start, n, set) == ref_find_consec(start, n, set));
+
+        size_t ref_count = 0;
+        for (size_t i = start; i < NBITS; i++) {
+            ref_count += ref[i] == set;
+        }
+        TEST_ASSERT(bitmap_count(map, start, NBITS, set) == ref_count);
+    }
+    check_all();
+}
+
+static void bench_density(const char* name, unsigned density_pct)
+{
+    for (size_t i = 0; i < NBITS; i++) {
+        if (test_rand_range(100) < density_pct) {
+            bitmap_set(map, i);
+        } else {
+            bitmap_clear(map, i);
+        }
+    }
+
+    unsigned long ops = TEST_ITERATIONS * 10;
+    volatile ssize_t sink = 0;
+    unsigned long start = test_time_ns();
+    for (unsigned long i = 0; i < ops; i++) {
+        sink += bitmap_find_nth(map, NBITS, 1, 0, BITMAP_NOT_SET);
+    }
+    test_bench_report(name, start, ops);
+    (void)sink;
+}
+
+void test_bench(void)
+{
+    bench_density("bitmap_find_nth first clear, 50% set", 50);
+    bench_density("bitmap_find_nth first clear, 99% set", 99);
+
+    bitmap_clear_consecutive(map, 0, NBITS);
+    bitmap_set_consecutive(map, 0, NBITS / 2);
+    unsigned long ops = TEST_ITERATIONS * 10;
+    volatile ssize_t sink = 0;
+    unsigned long start = test_time_ns();
+    for (unsigned long i = 0; i < ops; i++) {
+        sink += bitmap_find_consec(map, NBITS, 0, 16, BITMAP_NOT_SET);
+    }
+    test_bench_report("bitmap_find_consec 16 bits, half full", start, ops);
+    (void)sink;
+
+    start = test_time_ns();
+    for (unsigned long i = 0; i < ops; i++) {
+        bitmap_set_consecutive(map, 3, 512);
+        bitmap_clear_consecutive(map, 3, 512);
+    }
+    test_bench_report("bitmap_{set,clear}_consecutive 512 bits", start, ops);
+}
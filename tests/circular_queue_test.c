@@ -0,0 +1,92 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#include <test.h>
+#include <circular_queue.h>
+
+#define QUEUE_LEN (37)
+
+struct elem {
+    unsigned long val;
+    unsigned long pad[3];
+};
+
+struct container {
+    CQ_DEFINE(struct elem, queue, QUEUE_LEN);
+};
+
+static struct container c;
+
+/* Reference model: a plain array, indexes only ever grow */
+static unsigned long ref[TEST_ITERATIONS];
+static size_t ref_head;
+static size_t ref_tail;
+
+void test_run(void)
+{
+    unsigned long next = 0;
+    struct elem e;
+
+    CQ_INIT(&c, queue);
+    TEST_ASSERT(c.queue.capacity == QUEUE_LEN);
+    TEST_ASSERT(circular_queue_is_empty(&c.queue));
+    TEST_ASSERT(!circular_queue_pop(&c.queue, &e));
+
+    for (unsigned long it = 0; it < TEST_ITERATIONS; it++) {
+        size_t ref_len = ref_tail - ref_head;
+
+        TEST_ASSERT(circular_queue_is_empty(&c.queue) == (ref_len == 0));
+        TEST_ASSERT(circular_queue_is_full(&c.queue) == (ref_len == QUEUE_LEN));
+
+        /* Bias towards pushes in the first half and pops in the second to hit both ends */
+        bool push = test_rand_range(100) < ((it < (TEST_ITERATIONS / 2)) ? 60 : 40);
+        if (push) {
+            e.val = next;
+            bool ok = circular_queue_push(&c.queue, &e);
+            TEST_ASSERT(ok == (ref_len < QUEUE_LEN));
+            if (ok) {
+                ref[ref_tail++] = next++;
+            }
+        } else {
+            e.val = ~0UL;
+            bool ok = circular_queue_pop(&c.queue, &e);
+            TEST_ASSERT(ok == (ref_len > 0));
+            if (ok) {
+                TEST_ASSERT(e.val == ref[ref_head++]);
+            }
+        }
+    }
+
+    while (ref_head < ref_tail) {
+        TEST_ASSERT(circular_queue_pop(&c.queue, &e));
+        TEST_ASSERT(e.val == ref[ref_head++]);
+    }
+    TEST_ASSERT(circular_queue_is_empty(&c.queue));
+}
+
+void test_bench(void)
+{
+    unsigned long ops = TEST_ITERATIONS * 50;
+    struct elem e = { 0 };
+
+    CQ_INIT(&c, queue);
+    unsigned long start = test_time_ns();
+    for (unsigned long i = 0; i < ops; i++) {
+        e.val = i;
+        circular_queue_push(&c.queue, &e);
+        circular_queue_pop(&c.queue, &e);
+    }
+    test_bench_report("circular_queue push+pop, empty queue", start, ops);
+
+    for (size_t i = 0; i < (QUEUE_LEN / 2); i++) {
+        circular_queue_push(&c.queue, &e);
+    }
+    start = test_time_ns();
+    for (unsigned long i = 0; i < ops; i++) {
+        circular_queue_push(&c.queue, &e);
+        circular_queue_pop(&c.queue, &e);
+    }
+    test_bench_report("circular_queue push+pop, half full", start, ops);
+}
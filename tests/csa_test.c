@@ -0,0 +1,188 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#include <test.h>
+#include <platform.h>
+#include <arch/csa.h>
+#include <string.h>
+
+/**
+ * Model of the TriCore context save areas. csa_array is seen as one flat array of entries and a
+ * link is the flat index of the next entry, 0 standing for NULL as the first entry of core 0 is
+ * never linked. The link is kept in the first word of an entry, like PCXI/FCX links are on the
+ * hardware.
+ */
+
+#define CSA_NUM (PLAT_CPU_NUM * CSA_ENTRIES)
+
+struct csa_regs {
+    unsigned long fcx;
+    unsigned long lcx;
+    unsigned long pcxi;
+    bool depleted;
+};
+
+static union csa* entry(unsigned long idx)
+{
+    TEST_ASSERT(idx < CSA_NUM);
+    return &(&csa_array[0][0])[idx];
+}
+
+/* Writes may only ever touch the entries of the core owning the chain */
+static void store_link(unsigned long core_id, unsigned long idx, unsigned long link)
+{
+    TEST_ASSERT(idx >= (core_id * CSA_ENTRIES) && idx < ((core_id + 1) * CSA_ENTRIES));
+    entry(idx)->lower.pcxi = link;
+}
+
+/* Step by step transcription of _init_csa in boot.S */
+static void init_csa(struct csa_regs* regs, unsigned long core_id)
+{
+    unsigned long d10 = core_id * CSA_ENTRIES;
+    unsigned long d11 = CSA_ENTRIES;
+    unsigned long d12;
+    unsigned long a12 = d10;
+    unsigned long a7;
+
+    regs->pcxi = 0;
+
+    a12 = a12 + 1;
+    d12 = a12;
+    regs->fcx = d12;
+
+    d11 = d11 - 3;
+    a7 = d11;
+
+    /* loop: the body runs once more than the initial counter value */
+    while (true) {
+        d12 = d12 + 1;
+        store_link(core_id, a12, d12);
+        a12 = a12 + 1;
+        if (a7 == 0) {
+            break;
+        }
+        a7--;
+    }
+
+    store_link(core_id, a12, 0);
+    d12 = d12 - 1;
+    regs->lcx = d12;
+    regs->depleted = false;
+}
+
+/* CALL, or trap entry: the upper context is saved in the first free CSA */
+static void push(struct csa_regs* regs, unsigned long core_id, unsigned long ret_addr)
+{
+    unsigned long csa = regs->fcx;
+
+    /* a free context list underflow is a fatal trap */
+    TEST_ASSERT(csa != 0);
+
+    regs->fcx = entry(csa)->upper.pcxi;
+    store_link(core_id, csa, regs->pcxi);
+    entry(csa)->upper.csa_psw = ret_addr;
+    regs->pcxi = csa;
+
+    if (csa == regs->lcx) {
+        regs->depleted = true;
+    }
+}
+
+/* RET, or RFE: the saved context is restored and its CSA returned to the free list */
+static void pop(struct csa_regs* regs, unsigned long core_id)
+{
+    unsigned long csa = regs->pcxi;
+
+    TEST_ASSERT(csa != 0);
+    regs->pcxi = entry(csa)->upper.pcxi;
+    store_link(core_id, csa, regs->fcx);
+    regs->fcx = csa;
+}
+
+static void check_chain(struct csa_regs* regs, unsigned long core_id)
+{
+    unsigned long idx = regs->fcx;
+    bool lcx_in_chain = false;
+
+    /* A fresh chain holds every entry of the core but the first, in order */
+    for (unsigned long i = 1; i < CSA_ENTRIES; i++) {
+        TEST_ASSERT(idx == (core_id * CSA_ENTRIES) + i);
+        lcx_in_chain |= (idx == regs->lcx);
+        idx = entry(idx)->lower.pcxi;
+    }
+    TEST_ASSERT(idx == 0);
+    TEST_ASSERT(entry(core_id * CSA_ENTRIES)->lower.pcxi == 0);
+    TEST_ASSERT(lcx_in_chain);
+    /* The depletion trap itself still needs a free CSA past LCX */
+    TEST_ASSERT(entry(regs->lcx)->lower.pcxi != 0);
+}
+
+void test_run(void)
+{
+    struct csa_regs regs[PLAT_CPU_NUM];
+
+    memset(csa_array, 0, sizeof(csa_array));
+    for (unsigned long core_id = 0; core_id < PLAT_CPU_NUM; core_id++) {
+        init_csa(&regs[core_id], core_id);
+    }
+    for (unsigned long core_id = 0; core_id < PLAT_CPU_NUM; core_id++) {
+        check_chain(&regs[core_id], core_id);
+        TEST_ASSERT(csa_high_watermark(core_id) == 0);
+    }
+
+    size_t max_depth[PLAT_CPU_NUM] = { 0 };
+    size_t depth[PLAT_CPU_NUM] = { 0 };
+
+    for (unsigned long it = 0; it < TEST_ITERATIONS; it++) {
+        unsigned long core_id = test_rand_range(PLAT_CPU_NUM);
+        struct csa_regs* r = &regs[core_id];
+
+        /* Calls nest at most until the one taking LCX, which raises the depletion trap */
+        bool can_push = (r->lcx - (core_id * CSA_ENTRIES)) > depth[core_id];
+        if ((depth[core_id] == 0) || (can_push && test_rand_range(2))) {
+            TEST_ASSERT(can_push);
+            push(r, core_id, 0x80000000UL | it);
+            depth[core_id]++;
+            max_depth[core_id] = max(max_depth[core_id], depth[core_id]);
+            if (r->depleted) {
+                /* The trap handler saves its context in the entry past LCX and returns */
+                push(r, core_id, 0x80000000UL | it);
+                max_depth[core_id] = max(max_depth[core_id], depth[core_id] + 1);
+                pop(r, core_id);
+                r->depleted = false;
+            }
+        } else {
+            pop(r, core_id);
+            depth[core_id]--;
+        }
+
+        TEST_ASSERT(depth[core_id] < CSA_ENTRIES);
+        TEST_ASSERT(csa_high_watermark(core_id) == max_depth[core_id]);
+    }
+
+    /* Nesting up to the depletion trap uses every entry of the core and no other */
+    for (unsigned long core_id = 0; core_id < PLAT_CPU_NUM; core_id++) {
+        struct csa_regs* r = &regs[core_id];
+        while (!r->depleted) {
+            push(r, core_id, 0x80000000UL);
+            depth[core_id]++;
+        }
+        push(r, core_id, 0x80000000UL);
+        depth[core_id]++;
+        TEST_ASSERT(r->fcx == 0);
+        TEST_ASSERT(depth[core_id] == CSA_ENTRIES - 1);
+        TEST_ASSERT(csa_high_watermark(core_id) == CSA_ENTRIES - 1);
+    }
+
+    /* Unwinding everything gives back a full chain */
+    for (unsigned long core_id = 0; core_id < PLAT_CPU_NUM; core_id++) {
+        while (depth[core_id] > 0) {
+            pop(&regs[core_id], core_id);
+            depth[core_id]--;
+        }
+        TEST_ASSERT(regs[core_id].pcxi == 0);
+        regs[core_id].depleted = false;
+    }
+}
@@ -0,0 +1,14 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#ifndef __ARCH_BAO_H__
+#define __ARCH_BAO_H__
+
+/* Host stand-in for the architecture definitions needed by the core libraries */
+
+#define PAGE_SIZE  (0x1000)
+#define STACK_SIZE (PAGE_SIZE)
+
+#endif /* __ARCH_BAO_H__ */
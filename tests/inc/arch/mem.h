@@ -0,0 +1,15 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#ifndef __ARCH_MEM_H__
+#define __ARCH_MEM_H__
+
+#include <bao.h>
+
+/* Host stand-in for the MPU memory attributes, which the core never interprets */
+
+typedef unsigned long mem_flags_t;
+
+#endif /* __ARCH_MEM_H__ */
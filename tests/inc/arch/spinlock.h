@@ -0,0 +1,32 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#ifndef __ARCH_SPINLOCK__
+#define __ARCH_SPINLOCK__
+
+#include <bao.h>
+
+/* Host tests are single threaded, locks only track their state for sanity checks */
+
+typedef struct {
+    uint32_t locked;
+} spinlock_t;
+
+#define SPINLOCK_INITVAL ((spinlock_t){ 0 })
+
+static inline void spin_lock(spinlock_t* lock)
+{
+    if (lock->locked) {
+        ERROR("recursive lock\n");
+    }
+    lock->locked = 1;
+}
+
+static inline void spin_unlock(spinlock_t* lock)
+{
+    lock->locked = 0;
+}
+
+#endif /* __ARCH_SPINLOCK__ */
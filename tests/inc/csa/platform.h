@@ -0,0 +1,15 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#ifndef __PLATFORM_H__
+#define __PLATFORM_H__
+
+/* Host stand-in for a TriCore platform: only the number of cores sizing csa_array */
+
+#include <bao.h>
+
+#define PLAT_CPU_NUM (6)
+
+#endif /* __PLATFORM_H__ */
@@ -0,0 +1,30 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#ifndef __ARCH_MEM_H__
+#define __ARCH_MEM_H__
+
+#include <bao.h>
+
+/* Host stand-in for the MPU memory attributes. The core only compares them, through the raw
+value, so each kind of mapping gets a distinct one. */
+
+typedef union {
+    unsigned long raw;
+} mem_flags_t;
+
+#define PTE_INVALID        ((mem_flags_t){ .raw = 0 })
+#define PTE_HYP_FLAGS      ((mem_flags_t){ .raw = 1 })
+#define PTE_HYP_FLAGS_CODE ((mem_flags_t){ .raw = 2 })
+#define PTE_HYP_DEV_FLAGS  ((mem_flags_t){ .raw = 3 })
+#define PTE_VM_FLAGS       ((mem_flags_t){ .raw = 4 })
+#define PTE_VM_DEV_FLAGS   ((mem_flags_t){ .raw = 5 })
+
+static inline size_t mpu_granularity(void)
+{
+    return (size_t)PAGE_SIZE;
+}
+
+#endif /* __ARCH_MEM_H__ */
@@ -0,0 +1,13 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#ifndef __CONFIG_H__
+#define __CONFIG_H__
+
+#include <bao.h>
+#include <platform.h>
+#include <vm.h>
+
+#endif /* __CONFIG_H__ */
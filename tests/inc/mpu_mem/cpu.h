@@ -0,0 +1,51 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#ifndef __CPU_H__
+#define __CPU_H__
+
+/* Host stand-in for the per-cpu data used by the core MPU memory management: a single cpu, with
+inter-cpu messages recorded by the test */
+
+#include <bao.h>
+#include <platform_defs.h>
+#include <mem_prot/mem.h>
+#include <string.h>
+
+struct cpu_msg {
+    uint32_t handler;
+    uint32_t event;
+    uint64_t data;
+};
+
+typedef void (*cpu_msg_handler_t)(uint32_t event, uint64_t data);
+
+#define CPU_MSG_HANDLER(handler, handler_id)                                      \
+    __attribute__((used)) cpu_msg_handler_t __cpumsg_handler_##handler = handler; \
+    volatile const size_t handler_id;
+
+struct vcpu;
+
+struct cpu {
+    cpuid_t id;
+    struct addr_space as;
+    struct vcpu* vcpu;
+};
+
+extern struct cpu test_cpu;
+
+static inline struct cpu* cpu(void)
+{
+    return &test_cpu;
+}
+
+static inline bool cpu_is_master(void)
+{
+    return true;
+}
+
+void cpu_send_msg(cpuid_t cpu, struct cpu_msg* msg);
+
+#endif /* __CPU_H__ */
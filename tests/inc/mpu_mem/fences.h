@@ -0,0 +1,15 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#ifndef __FENCES_H__
+#define __FENCES_H__
+
+/* Host tests are single threaded */
+
+#define fence_ord_write()
+#define fence_sync_write()
+#define fence_sync()
+
+#endif /* __FENCES_H__ */
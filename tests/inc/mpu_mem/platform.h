@@ -0,0 +1,22 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#ifndef __PLATFORM_H__
+#define __PLATFORM_H__
+
+/* Host stand-in for an MPU platform: only the cpu count and the MMIO windows used by the core
+MPU memory management */
+
+#include <bao.h>
+#include <platform_defs.h>
+
+struct platform {
+    size_t mmio_region_num;
+    struct mem_region* mmio_regions;
+};
+
+extern struct platform platform;
+
+#endif /* __PLATFORM_H__ */
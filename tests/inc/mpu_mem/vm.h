@@ -0,0 +1,23 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#ifndef __VM_H__
+#define __VM_H__
+
+/* Host stand-in for the VM fields used by the core MPU memory management */
+
+#include <bao.h>
+#include <cpu.h>
+
+struct vm {
+    cpumap_t cpus;
+    struct addr_space as;
+};
+
+struct vcpu {
+    struct vm* vm;
+};
+
+#endif /* __VM_H__ */
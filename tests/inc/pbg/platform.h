@@ -0,0 +1,26 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#ifndef __PLATFORM_H__
+#define __PLATFORM_H__
+
+/* Host stand-in for the RH850 U2A16 platform: only the device table used by the P-Bus guard
+driver, with the guard registers backed by memory */
+
+#include <bao.h>
+#include <arch/platform.h>
+
+#define PLAT_PBG_BASE ((unsigned long)&pbg_test_hw)
+
+#include <plat/pbg.h>
+
+struct platform {
+    struct arch_platform arch;
+};
+
+extern struct platform platform;
+extern struct pbg_hw pbg_test_hw;
+
+#endif /* __PLATFORM_H__ */
@@ -0,0 +1,69 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#ifndef __TEST_H__
+#define __TEST_H__
+
+#include <bao.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * Minimal harness for the host unit tests. Each test program checks its unit against a simple
+ * reference model using pseudo-random operation sequences and, when run with the "bench"
+ * argument, also reports the average cost of the main operations in ns/op.
+ */
+
+#define TEST_ASSERT(cond)                                                                  \
+    do {                                                                                   \
+        if (!(cond)) {                                                                     \
+            fprintf(stderr, "%s:%d: assertion failed: %s (seed %lu)\n", __FILE__, __LINE__, \
+                #cond, test_seed);                                                         \
+            exit(EXIT_FAILURE);                                                            \
+        }                                                                                  \
+    } while (0)
+
+#define TEST_ITERATIONS (20000UL)
+
+extern unsigned long test_seed;
+
+/* xorshift64, good enough to generate operation sequences and reproducible from the seed */
+static inline unsigned long test_rand(void)
+{
+    static unsigned long state = 0;
+    if (state == 0) {
+        state = test_seed | 1UL;
+    }
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static inline unsigned long test_rand_range(unsigned long n)
+{
+    return test_rand() % n;
+}
+
+static inline unsigned long test_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((unsigned long)ts.tv_sec * 1000000000UL) + (unsigned long)ts.tv_nsec;
+}
+
+static inline void test_bench_report(const char* name, unsigned long start_ns, unsigned long ops)
+{
+    unsigned long elapsed = test_time_ns() - start_ns;
+    printf("  %-40s %10.1f ns/op\n", name, (double)elapsed / (double)ops);
+}
+
+/* Defined by each test program. Only programs testing code on a measurable path define
+test_bench. */
+void test_run(void);
+void test_bench(void) __attribute__((weak));
+
+#endif /* __TEST_H__ */
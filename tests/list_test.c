@@ -0,0 +1,178 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#include <test.h>
+#include <list.h>
+
+#define NODE_NUM (64)
+
+struct item {
+    node_t node;
+    unsigned long key;
+    bool in_list;
+};
+
+static struct item items[NODE_NUM];
+static struct list list;
+
+/* Reference model: the expected list contents in order */
+static struct item* ref[NODE_NUM];
+static size_t ref_len;
+
+static int item_cmp(node_t* a, node_t* b)
+{
+    unsigned long ka = ((struct item*)a)->key;
+    unsigned long kb = ((struct item*)b)->key;
+    return (ka > kb) - (ka < kb);
+}
+
+static void ref_insert(size_t pos, struct item* item)
+{
+    for (size_t i = ref_len; i > pos; i--) {
+        ref[i] = ref[i - 1];
+    }
+    ref[pos] = item;
+    ref_len++;
+}
+
+static void ref_remove(size_t pos)
+{
+    for (size_t i = pos; i + 1 < ref_len; i++) {
+        ref[i] = ref[i + 1];
+    }
+    ref_len--;
+}
+
+static void check_list(void)
+{
+    size_t i = 0;
+    struct item* last = NULL;
+
+    list_foreach (list, struct item, it) {
+        TEST_ASSERT(i < ref_len);
+        TEST_ASSERT(it == ref[i]);
+        last = it;
+        i++;
+    }
+    TEST_ASSERT(i == ref_len);
+    TEST_ASSERT((struct item*)list.tail == last);
+    TEST_ASSERT(list_empty(&list) == (ref_len == 0));
+    TEST_ASSERT((struct item*)list_peek(&list) == (ref_len > 0 ? ref[0] : NULL));
+}
+
+static struct item* pick_item(bool in_list)
+{
+    size_t first = test_rand_range(NODE_NUM);
+    for (size_t i = 0; i < NODE_NUM; i++) {
+        struct item* item = &items[(first + i) % NODE_NUM];
+        if (item->in_list == in_list) {
+            return item;
+        }
+    }
+    return NULL;
+}
+
+/* Inserts in key order, after any nodes with an equal key */
+static void ordered_insert(struct item* item)
+{
+    size_t pos = 0;
+    while (pos < ref_len && ref[pos]->key <= item->key) {
+        pos++;
+    }
+    list_insert_ordered(&list, &item->node, item_cmp);
+    ref_insert(pos, item);
+    item->in_list = true;
+}
+
+void test_run(void)
+{
+    list_init(&list);
+    TEST_ASSERT(list_pop(&list) == NULL);
+
+    /* Alternate between FIFO use and sorted use, both interleaved with removals */
+    for (unsigned long it = 0; it < TEST_ITERATIONS; it++) {
+        bool sorted = (it / 1000) % 2;
+        struct item* item;
+
+        if (it % 1000 == 0) {
+            while (list_pop(&list) != NULL) { }
+            ref_len = 0;
+            for (size_t i = 0; i < NODE_NUM; i++) {
+                items[i].in_list = false;
+            }
+        }
+
+        switch (test_rand_range(3)) {
+            case 0:
+                item = pick_item(false);
+                if (item == NULL) {
+                    break;
+                }
+                if (sorted) {
+                    item->key = test_rand_range(16);
+                    ordered_insert(item);
+                } else {
+                    list_push(&list, &item->node);
+                    ref_insert(ref_len, item);
+                    item->in_list = true;
+                }
+                break;
+            case 1:
+                item = (struct item*)list_pop(&list);
+                TEST_ASSERT(item == (ref_len > 0 ? ref[0] : NULL));
+                if (item != NULL) {
+                    TEST_ASSERT(item->node == NULL);
+                    ref_remove(0);
+                    item->in_list = false;
+                }
+                break;
+            default:
+                item = pick_item(true);
+                if (item == NULL) {
+                    /* Removing a node that is not in the list must leave it untouched */
+                    list_rm(&list, &items[0].node);
+                    break;
+                }
+                list_rm(&list, &item->node);
+                for (size_t i = 0; i < ref_len; i++) {
+                    if (ref[i] == item) {
+                        ref_remove(i);
+                        break;
+                    }
+                }
+                item->in_list = false;
+                break;
+        }
+        check_list();
+    }
+}
+
+void test_bench(void)
+{
+    unsigned long ops = TEST_ITERATIONS * 50;
+
+    list_init(&list);
+    unsigned long start = test_time_ns();
+    for (unsigned long i = 0; i < ops; i++) {
+        list_push(&list, &items[i % NODE_NUM].node);
+        (void)list_pop(&list);
+    }
+    test_bench_report("list push+pop", start, ops);
+
+    list_init(&list);
+    for (size_t i = 0; i < NODE_NUM; i++) {
+        items[i].key = i;
+    }
+    ops = TEST_ITERATIONS * 5;
+    start = test_time_ns();
+    for (unsigned long i = 0; i < ops; i++) {
+        size_t n = i % NODE_NUM;
+        if (n == 0) {
+            list_init(&list);
+        }
+        list_insert_ordered(&list, &items[n].node, item_cmp);
+    }
+    test_bench_report("list_insert_ordered at tail, <64 nodes", start, ops);
+}
@@ -0,0 +1,59 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#include <test.h>
+#include <stdarg.h>
+
+unsigned long test_seed;
+
+/* Host replacement for the hypervisor console. ERROR never returns in the hypervisor, so make it
+fail the test instead of spinning. */
+void console_printk(const char* fmt, ...)
+{
+    static const char error_prefix[] = "BAO ERROR: ";
+    va_list args;
+
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+
+    for (size_t i = 0; error_prefix[i] == fmt[i]; i++) {
+        if (error_prefix[i + 1] == '\0') {
+            abort();
+        }
+    }
+}
+
+static bool arg_is(const char* arg, const char* name)
+{
+    while (*arg != '\0' && *arg == *name) {
+        arg++;
+        name++;
+    }
+    return *arg == *name;
+}
+
+/* Usage: <test> [bench] [seed] */
+int main(int argc, char** argv)
+{
+    bool bench = false;
+
+    test_seed = (unsigned long)time(NULL);
+    for (int i = 1; i < argc; i++) {
+        if (arg_is(argv[i], "bench")) {
+            bench = true;
+        } else {
+            test_seed = strtoul(argv[i], NULL, 0);
+        }
+    }
+
+    printf("%s (seed %lu)\n", argv[0], test_seed);
+    test_run();
+    if (bench && (test_bench != NULL)) {
+        test_bench();
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,318 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#include <test.h>
+#include <mem.h>
+#include <vm.h>
+#include <platform.h>
+
+/**
+ * Checks the vMPU region algebra of the core MPU memory management (insertion, splitting on partial
+ * unmaps and coalescing of contiguous regions) against a list of intervals. The physical MPU is
+ * modelled as the set of regions it was asked to hold, which must always match the vMPU.
+ */
+
+/* Small enough that splitting a region never runs out of vMPU entries */
+#define TEST_PAGES (VMPU_NUM_ENTRIES - 4)
+#define TEST_BASE  (0x100000UL)
+
+struct interval {
+    vaddr_t base;
+    size_t size;
+    unsigned long flags;
+    bool lock;
+};
+
+/* Not exposed by the core, only used between its MPU memory management sources */
+bool mem_unmap_range(struct addr_space* as, vaddr_t vaddr, size_t size, bool broadcast);
+
+struct cpu test_cpu;
+struct platform platform;
+struct list page_pool_list;
+uint8_t _image_start, _image_load_end, _image_noload_start, _image_end;
+
+static struct vm vm;
+static struct vcpu vcpu;
+static struct addr_space* as = &vm.as;
+
+static struct interval ref[VMPU_NUM_ENTRIES];
+static size_t ref_num;
+
+static struct interval mpu[VMPU_NUM_ENTRIES];
+static size_t mpu_num;
+
+void cpu_send_msg(cpuid_t cpu, struct cpu_msg* msg)
+{
+    UNUSED_ARG(cpu);
+    UNUSED_ARG(msg);
+
+    /* Only this cpu shares the address space */
+    TEST_ASSERT(false);
+}
+
+void as_arch_init(struct addr_space* as)
+{
+    UNUSED_ARG(as);
+}
+
+void mpu_init(void) { }
+
+void mpu_enable(void) { }
+
+static size_t mpu_find(vaddr_t base)
+{
+    for (size_t i = 0; i < mpu_num; i++) {
+        if (mpu[i].base == base) {
+            return i;
+        }
+    }
+    return mpu_num;
+}
+
+bool mpu_map(struct addr_space* as, struct mp_region* mpr, bool locked)
+{
+    UNUSED_ARG(as);
+
+    TEST_ASSERT(mpu_find(mpr->base) == mpu_num);
+    mpu[mpu_num++] = (struct interval){ mpr->base, mpr->size, mpr->mem_flags.raw, locked };
+    return true;
+}
+
+bool mpu_unmap(struct addr_space* as, struct mp_region* mpr)
+{
+    UNUSED_ARG(as);
+
+    size_t i = mpu_find(mpr->base);
+    TEST_ASSERT(i < mpu_num);
+    mpu[i] = mpu[--mpu_num];
+    return true;
+}
+
+bool mpu_update(struct addr_space* as, struct mp_region* mpr)
+{
+    UNUSED_ARG(as);
+
+    size_t i = mpu_find(mpr->base);
+    TEST_ASSERT(i < mpu_num);
+    mpu[i].size = mpr->size;
+    return true;
+}
+
+bool mpu_perms_compatible(unsigned long perms1, unsigned long perms2)
+{
+    return perms1 == perms2;
+}
+
+static bool intervals_overlap(vaddr_t base1, size_t size1, vaddr_t base2, size_t size2)
+{
+    return (base1 < (base2 + size2)) && (base2 < (base1 + size1));
+}
+
+static void ref_remove(size_t i)
+{
+    ref[i] = ref[--ref_num];
+}
+
+static void ref_coalesce(void)
+{
+    bool merged = true;
+
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < ref_num && !merged; i++) {
+            for (size_t j = 0; j < ref_num && !merged; j++) {
+                if ((ref[i].base + ref[i].size == ref[j].base) && (ref[i].flags == ref[j].flags) &&
+                    !ref[i].lock && !ref[j].lock) {
+                    ref[i].size += ref[j].size;
+                    ref_remove(j);
+                    merged = true;
+                }
+            }
+        }
+    }
+}
+
+static bool ref_map(vaddr_t base, size_t size, unsigned long flags, bool lock)
+{
+    for (size_t i = 0; i < ref_num; i++) {
+        if (intervals_overlap(base, size, ref[i].base, ref[i].size)) {
+            return false;
+        }
+    }
+
+    ref[ref_num++] = (struct interval){ base, size, flags, lock };
+    if (!lock) {
+        ref_coalesce();
+    }
+    return true;
+}
+
+/* Returns whether the whole range was mapped */
+static bool ref_unmap(vaddr_t base, size_t size)
+{
+    size_t unmapped = 0;
+    size_t i = 0;
+
+    while (i < ref_num) {
+        struct interval r = ref[i];
+        if (!intervals_overlap(base, size, r.base, r.size)) {
+            i++;
+            continue;
+        }
+        vaddr_t lo = max(base, r.base);
+        vaddr_t hi = min(base + size, r.base + r.size);
+        unmapped += hi - lo;
+        ref_remove(i);
+        if (r.base < lo) {
+            ref[ref_num++] = (struct interval){ r.base, lo - r.base, r.flags, r.lock };
+        }
+        if (hi < r.base + r.size) {
+            ref[ref_num++] = (struct interval){ hi, r.base + r.size - hi, r.flags, r.lock };
+        }
+        /* The pieces of r are outside the range, so the scan can restart from the same index */
+    }
+
+    return unmapped == size;
+}
+
+static bool ref_contains(const struct interval* set, size_t num, const struct interval* r)
+{
+    for (size_t i = 0; i < num; i++) {
+        if (set[i].base == r->base && set[i].size == r->size && set[i].flags == r->flags) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void check_regions(void)
+{
+    size_t valid = 0;
+
+    for (mpid_t i = 0; i < VMPU_NUM_ENTRIES; i++) {
+        struct mpe* mpe = &as->vmpu.node[i];
+        if (mpe->state != MPE_S_VALID) {
+            continue;
+        }
+        struct interval r = { mpe->region.base, mpe->region.size, mpe->region.mem_flags.raw,
+            mpe->lock };
+        TEST_ASSERT(ref_contains(ref, ref_num, &r));
+        TEST_ASSERT(ref_contains(mpu, mpu_num, &r));
+        valid++;
+    }
+    TEST_ASSERT(valid == ref_num);
+    TEST_ASSERT(mpu_num == ref_num);
+    TEST_ASSERT(as->vmpu.sorted_num == ref_num);
+
+    for (size_t i = 1; i < as->vmpu.sorted_num; i++) {
+        TEST_ASSERT(as->vmpu.node[as->vmpu.sorted[i - 1]].region.base <
+            as->vmpu.node[as->vmpu.sorted[i]].region.base);
+    }
+}
+
+static void check_translate(void)
+{
+    for (size_t i = 0; i < 8; i++) {
+        vaddr_t addr = TEST_BASE + test_rand_range((TEST_PAGES + 2) * PAGE_SIZE) - PAGE_SIZE;
+        bool mapped = false;
+        paddr_t pa = 0;
+        for (size_t j = 0; j < ref_num; j++) {
+            mapped = mapped || intervals_overlap(addr, 1, ref[j].base, ref[j].size);
+        }
+        TEST_ASSERT(mem_translate(as, addr, &pa) == mapped);
+        TEST_ASSERT(!mapped || pa == addr);
+    }
+}
+
+static void test_init(void)
+{
+    test_cpu.id = 0;
+    test_cpu.vcpu = &vcpu;
+    vcpu.vm = &vm;
+    vm.cpus = 1UL << test_cpu.id;
+    as_init(as, AS_VM, 0);
+    ref_num = 0;
+    mpu_num = 0;
+}
+
+static void random_range(vaddr_t* base, size_t* size)
+{
+    size_t first = test_rand_range(TEST_PAGES);
+    size_t num = 1 + test_rand_range(min((size_t)8, TEST_PAGES - first));
+    *base = TEST_BASE + first * PAGE_SIZE;
+    *size = num * PAGE_SIZE;
+}
+
+void test_run(void)
+{
+    test_init();
+
+    for (unsigned long it = 0; it < TEST_ITERATIONS; it++) {
+        /* Drift between a sparse and an almost fully mapped range */
+        unsigned long map_pct = ((it / 500) % 2) ? 30 : 70;
+        vaddr_t base;
+        size_t size;
+
+        random_range(&base, &size);
+        if (test_rand_range(100) < map_pct) {
+            /* Few distinct attributes, so that contiguous regions often coalesce */
+            bool lock = test_rand_range(8) == 0;
+            struct mp_region mpr = {
+                .base = base,
+                .size = size,
+                .mem_flags = { .raw = 1 + test_rand_range(2) },
+                .as_sec = SEC_VM_ANY,
+            };
+            bool expected = ref_map(base, size, mpr.mem_flags.raw, lock);
+            TEST_ASSERT(mem_map(as, &mpr, true, lock) == expected);
+        } else {
+            bool expected = ref_unmap(base, size);
+            TEST_ASSERT(mem_unmap_range(as, base, size, true) == expected);
+        }
+
+        check_regions();
+        check_translate();
+    }
+}
+
+void test_bench(void)
+{
+    unsigned long ops = TEST_ITERATIONS * 5;
+
+    /* Every other page mapped, with distinct attributes so nothing coalesces */
+    test_init();
+    for (size_t i = 0; i < TEST_PAGES; i += 2) {
+        struct mp_region mpr = {
+            .base = TEST_BASE + i * PAGE_SIZE,
+            .size = PAGE_SIZE,
+            .mem_flags = { .raw = 1 + ((i / 2) % 2) },
+            .as_sec = SEC_VM_ANY,
+        };
+        mem_map(as, &mpr, true, false);
+    }
+
+    unsigned long start = test_time_ns();
+    for (unsigned long i = 0; i < ops; i++) {
+        struct mp_region mpr = {
+            .base = TEST_BASE + (((i % (TEST_PAGES / 2)) * 2) + 1) * PAGE_SIZE,
+            .size = PAGE_SIZE,
+            .mem_flags = { .raw = 3 },
+            .as_sec = SEC_VM_ANY,
+        };
+        mem_map(as, &mpr, true, false);
+        mem_unmap_range(as, mpr.base, mpr.size, true);
+    }
+    test_bench_report("mem_map+mem_unmap_range, half full vMPU", start, ops);
+
+    volatile bool sink = false;
+    paddr_t pa;
+    ops = TEST_ITERATIONS * 50;
+    start = test_time_ns();
+    for (unsigned long i = 0; i < ops; i++) {
+        sink = mem_translate(as, TEST_BASE + (i % TEST_PAGES) * PAGE_SIZE, &pa);
+    }
+    test_bench_report("mem_translate, half full vMPU", start, ops);
+    (void)sink;
+}
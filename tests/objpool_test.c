@@ -0,0 +1,90 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#include <test.h>
+#include <objpool.h>
+
+#define OBJ_NUM (200)
+
+struct obj {
+    unsigned long id;
+    char data[40];
+};
+
+OBJPOOL_ALLOC(pool, struct obj, OBJ_NUM);
+
+/* Reference model: which objects are allocated */
+static bool ref[OBJ_NUM];
+static size_t ref_allocated;
+
+static size_t ref_first_free(void)
+{
+    size_t i = 0;
+    while (i < OBJ_NUM && ref[i]) {
+        i++;
+    }
+    return i;
+}
+
+void test_run(void)
+{
+    objpool_init(&pool);
+
+    for (unsigned long it = 0; it < TEST_ITERATIONS; it++) {
+        /* Drift between an almost empty and an almost full pool */
+        unsigned long alloc_pct = ((it / 2000) % 2) ? 30 : 70;
+
+        if (test_rand_range(100) < alloc_pct) {
+            objpool_id_t id;
+            struct obj* obj = objpool_alloc_with_id(&pool, &id);
+            size_t expected = ref_first_free();
+
+            if (expected == OBJ_NUM) {
+                TEST_ASSERT(obj == NULL);
+            } else {
+                TEST_ASSERT(obj != NULL);
+                TEST_ASSERT(id == expected);
+                TEST_ASSERT(objpool_get_by_id(&pool, id) == obj);
+                obj->id = id;
+                ref[id] = true;
+                ref_allocated++;
+            }
+        } else if (ref_allocated > 0) {
+            size_t n = test_rand_range(OBJ_NUM);
+            while (!ref[n]) {
+                n = (n + 1) % OBJ_NUM;
+            }
+            struct obj* obj = objpool_get_by_id(&pool, n);
+            TEST_ASSERT(obj->id == n);
+            objpool_free(&pool, obj);
+            ref[n] = false;
+            ref_allocated--;
+        }
+    }
+
+    TEST_ASSERT(objpool_get_by_id(&pool, OBJ_NUM) == NULL);
+    TEST_ASSERT(bitmap_count(pool.bitmap, 0, OBJ_NUM, BITMAP_SET) == ref_allocated);
+}
+
+static void bench_churn(const char* name, size_t prefill)
+{
+    unsigned long ops = TEST_ITERATIONS * 20;
+
+    objpool_init(&pool);
+    for (size_t i = 0; i < prefill; i++) {
+        (void)objpool_alloc(&pool);
+    }
+    unsigned long start = test_time_ns();
+    for (unsigned long i = 0; i < ops; i++) {
+        objpool_free(&pool, objpool_alloc(&pool));
+    }
+    test_bench_report(name, start, ops);
+}
+
+void test_bench(void)
+{
+    bench_churn("objpool alloc+free, empty pool", 0);
+    bench_churn("objpool alloc+free, 90% used", (OBJ_NUM * 9) / 10);
+}
@@ -0,0 +1,184 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#include <test.h>
+#include <page_pool.h>
+
+#define POOL_PAGES (1024)
+/* Not aligned to the larger allocation sizes, so aligned requests can't start at index 0 */
+#define POOL_BASE  (0x80003000UL)
+
+static BITMAP_ALLOC(pool_bitmap, POOL_PAGES);
+static struct page_pool pool;
+
+/* Reference model: which pages are allocated */
+static bool ref[POOL_PAGES];
+static size_t ref_free;
+
+static void pool_init(void)
+{
+    bitmap_clear_consecutive(pool_bitmap, 0, POOL_PAGES);
+    pool = (struct page_pool){
+        .base = POOL_BASE,
+        .num_pages = POOL_PAGES,
+        .free = POOL_PAGES,
+        .last = 0,
+        .bitmap = pool_bitmap,
+        .lock = SPINLOCK_INITVAL,
+    };
+    for (size_t i = 0; i < POOL_PAGES; i++) {
+        ref[i] = false;
+    }
+    ref_free = POOL_PAGES;
+}
+
+static bool ref_is_aligned(size_t page, size_t num)
+{
+    return (((POOL_BASE / PAGE_SIZE) + page) % num) == 0;
+}
+
+static bool ref_range_free(size_t page, size_t num)
+{
+    for (size_t i = page; i < page + num; i++) {
+        if (ref[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool ref_can_alloc(size_t num, bool aligned)
+{
+    for (size_t i = 0; i + num <= POOL_PAGES; i++) {
+        if ((!aligned || ref_is_aligned(i, num)) && ref_range_free(i, num)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void pool_free(size_t page, size_t num)
+{
+    bitmap_clear_consecutive(pool.bitmap, page, num);
+    pool.free += num;
+    for (size_t i = page; i < page + num; i++) {
+        ref[i] = false;
+    }
+    ref_free += num;
+}
+
+static void check_alloc(size_t num, bool aligned)
+{
+    struct ppages ppages;
+    bool ok = pp_alloc(&pool, num, aligned, &ppages);
+
+    TEST_ASSERT(ok == ref_can_alloc(num, aligned));
+    if (!ok) {
+        TEST_ASSERT(ppages.num_pages == 0);
+        return;
+    }
+
+    TEST_ASSERT(ppages.num_pages == num);
+    TEST_ASSERT(ppages.base >= POOL_BASE);
+    TEST_ASSERT(((ppages.base - POOL_BASE) % PAGE_SIZE) == 0);
+    size_t page = (ppages.base - POOL_BASE) / PAGE_SIZE;
+    TEST_ASSERT(page + num <= POOL_PAGES);
+    TEST_ASSERT(ref_range_free(page, num));
+    if (aligned) {
+        TEST_ASSERT(ref_is_aligned(page, num));
+    }
+
+    for (size_t i = page; i < page + num; i++) {
+        ref[i] = true;
+    }
+    ref_free -= num;
+    TEST_ASSERT(pool.free == ref_free);
+}
+
+/* Frees random single pages until roughly @pct percent of the pool is free */
+static void fragment(unsigned pct)
+{
+    for (size_t i = 0; i < POOL_PAGES; i++) {
+        if (!ref[i] && (test_rand_range(100) >= pct)) {
+            bitmap_set(pool.bitmap, i);
+            pool.free--;
+            ref[i] = true;
+            ref_free--;
+        }
+    }
+}
+
+void test_run(void)
+{
+    struct ppages ppages;
+
+    pool_init();
+    TEST_ASSERT(pp_alloc(&pool, 0, false, &ppages) && ppages.num_pages == 0);
+
+    for (unsigned long it = 0; it < TEST_ITERATIONS; it++) {
+        if ((it % 500) == 0) {
+            pool_init();
+            fragment((unsigned)test_rand_range(101));
+        }
+
+        if (test_rand_range(3) != 0) {
+            size_t num = 1UL << test_rand_range(7);
+            check_alloc(num + (test_rand_range(2) ? test_rand_range(num) : 0),
+                test_rand_range(2));
+        } else {
+            size_t page = test_rand_range(POOL_PAGES);
+            size_t num = 1 + test_rand_range(32);
+            while (page < POOL_PAGES && !ref[page]) {
+                page++;
+            }
+            if (page == POOL_PAGES) {
+                continue;
+            }
+            size_t used = 0;
+            while (used < num && (page + used) < POOL_PAGES && ref[page + used]) {
+                used++;
+            }
+            pool_free(page, used);
+        }
+        TEST_ASSERT(bitmap_count(pool.bitmap, 0, POOL_PAGES, BITMAP_NOT_SET) == ref_free);
+    }
+}
+
+static void bench_alloc(const char* name, unsigned free_pct, size_t num, bool aligned)
+{
+    unsigned long ops = TEST_ITERATIONS;
+    unsigned long elapsed = 0;
+    unsigned long done = 0;
+    struct ppages ppages;
+
+    pool_init();
+    fragment(free_pct);
+    for (unsigned long i = 0; i < ops; i++) {
+        unsigned long start = test_time_ns();
+        bool ok = pp_alloc(&pool, num, aligned, &ppages);
+        elapsed += test_time_ns() - start;
+        done++;
+        if (!ok) {
+            pool_init();
+            fragment(free_pct);
+        } else {
+            /* Give the pages back so the fragmentation level stays the same */
+            bitmap_clear_consecutive(pool.bitmap, (ppages.base - POOL_BASE) / PAGE_SIZE, num);
+            pool.free += num;
+        }
+    }
+    test_bench_report(name, test_time_ns() - elapsed, done);
+}
+
+void test_bench(void)
+{
+    bench_alloc("pp_alloc 1 page, 0% fragmented", 100, 1, false);
+    bench_alloc("pp_alloc 1 page, 50% fragmented", 50, 1, false);
+    bench_alloc("pp_alloc 1 page, 90% fragmented", 10, 1, false);
+    bench_alloc("pp_alloc 8 pages, 0% fragmented", 100, 8, false);
+    bench_alloc("pp_alloc 8 pages, 50% fragmented", 50, 8, false);
+    bench_alloc("pp_alloc 8 pages aligned, 0% frag", 100, 8, true);
+    bench_alloc("pp_alloc 8 pages aligned, 50% frag", 50, 8, true);
+}
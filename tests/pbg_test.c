@@ -0,0 +1,164 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#include <test.h>
+#include <platform.h>
+#include <arch/vmm.h>
+#include <stddef.h>
+#include <string.h>
+
+#define DEV_NUM     (8)
+#define DEV_MAX_PBG (3)
+#define SPID_ALL    ((1U << 17) - 1)
+
+struct pbg_hw pbg_test_hw;
+struct platform platform;
+
+static const size_t group_offsets[] = {
+    offsetof(struct pbg_hw, PBG00),
+    offsetof(struct pbg_hw, PBG01),
+    offsetof(struct pbg_hw, PBG10),
+    offsetof(struct pbg_hw, PBG20),
+    offsetof(struct pbg_hw, PBG21),
+    offsetof(struct pbg_hw, PBG22),
+    offsetof(struct pbg_hw, PBG30),
+    offsetof(struct pbg_hw, PBG31),
+    offsetof(struct pbg_hw, PBG32),
+    offsetof(struct pbg_hw, PBG33),
+    offsetof(struct pbg_hw, PBG40),
+    offsetof(struct pbg_hw, PBG50),
+    offsetof(struct pbg_hw, PBG51),
+    offsetof(struct pbg_hw, PBG52),
+    offsetof(struct pbg_hw, PBG53),
+    offsetof(struct pbg_hw, PBG6L0),
+    offsetof(struct pbg_hw, PBG6L1),
+    offsetof(struct pbg_hw, PBG6H0),
+    offsetof(struct pbg_hw, PBG70),
+    offsetof(struct pbg_hw, PBG80),
+    offsetof(struct pbg_hw, PBG90),
+};
+
+#define GROUP_NUM (sizeof(group_offsets) / sizeof(group_offsets[0]))
+
+static const size_t errslv_offsets[] = {
+    offsetof(struct pbg_hw, PBGERRSLV00),
+    offsetof(struct pbg_hw, PBGERRSLV10),
+    offsetof(struct pbg_hw, PBGERRSLV20),
+    offsetof(struct pbg_hw, PBGERRSLV30),
+    offsetof(struct pbg_hw, PBGERRSLV40),
+    offsetof(struct pbg_hw, PBGERRSLV50),
+    offsetof(struct pbg_hw, PBGERRSLV6L0),
+    offsetof(struct pbg_hw, PBGERRSLV6L1),
+    offsetof(struct pbg_hw, PBGERRSLV6H0),
+    offsetof(struct pbg_hw, PBGERRSLV70),
+    offsetof(struct pbg_hw, PBGERRSLV80),
+    offsetof(struct pbg_hw, PBGERRSLV90),
+};
+
+#define ERRSLV_NUM (sizeof(errslv_offsets) / sizeof(errslv_offsets[0]))
+
+static struct plat_device devices[DEV_NUM];
+static unsigned long dev_pbg_prot[DEV_NUM][DEV_MAX_PBG];
+
+/* Reference model: the expected PBGPROT1 of every guard channel */
+static uint32_t ref[GROUP_NUM][PLAT_NUM_PBG_CHANNELS];
+
+static struct pbg_channel* channel(size_t group, size_t ch)
+{
+    return &((struct pbgn*)((uintptr_t)&pbg_test_hw + group_offsets[group]))->ch[ch];
+}
+
+static struct pbgerrslvn* errslv(size_t n)
+{
+    return (struct pbgerrslvn*)((uintptr_t)&pbg_test_hw + errslv_offsets[n]);
+}
+
+static void check_hw(void)
+{
+    for (size_t g = 0; g < GROUP_NUM; g++) {
+        for (size_t c = 0; c < PLAT_NUM_PBG_CHANNELS; c++) {
+            TEST_ASSERT(channel(g, c)->PBGPROT1 == ref[g][c]);
+            TEST_ASSERT(channel(g, c)->PBGPROT0 == 0);
+        }
+    }
+    /* The write key is always left locked */
+    for (size_t n = 0; n < ERRSLV_NUM; n++) {
+        TEST_ASSERT(errslv(n)->PBGKCPROT == PBGKCPROT_DISABLE_WR);
+    }
+}
+
+/* Describes DEV_NUM devices, each behind a few random guard channels which may be shared */
+static void random_platform(void)
+{
+    memset(&pbg_test_hw, 0, sizeof(pbg_test_hw));
+    for (size_t g = 0; g < GROUP_NUM; g++) {
+        for (size_t c = 0; c < PLAT_NUM_PBG_CHANNELS; c++) {
+            ref[g][c] = SPID_ALL;
+        }
+    }
+
+    for (size_t i = 0; i < DEV_NUM; i++) {
+        devices[i].dev_base = 0xFFC00000UL + (i * 0x1000UL);
+        devices[i].pbg_num = 1 + test_rand_range(DEV_MAX_PBG);
+        devices[i].pbg_prot = dev_pbg_prot[i];
+        for (size_t j = 0; j < devices[i].pbg_num; j++) {
+            size_t g = test_rand_range(GROUP_NUM);
+            size_t c = test_rand_range(PLAT_NUM_PBG_CHANNELS);
+            dev_pbg_prot[i][j] = (unsigned long)&channel(g, c)->PBGPROT1;
+            ref[g][c] = 1U << HYP_SPID;
+        }
+    }
+    platform.arch.devices = devices;
+    platform.arch.device_num = DEV_NUM;
+}
+
+static void ref_allow(const struct plat_device* dev, unsigned long spid)
+{
+    for (size_t j = 0; j < dev->pbg_num; j++) {
+        for (size_t g = 0; g < GROUP_NUM; g++) {
+            for (size_t c = 0; c < PLAT_NUM_PBG_CHANNELS; c++) {
+                if (dev->pbg_prot[j] == (unsigned long)&channel(g, c)->PBGPROT1) {
+                    ref[g][c] |= 1U << spid;
+                }
+            }
+        }
+    }
+}
+
+void test_run(void)
+{
+    for (unsigned long round = 0; round < 50; round++) {
+        random_platform();
+        pbg_init();
+        check_hw();
+
+        for (unsigned long it = 0; it < (TEST_ITERATIONS / 100); it++) {
+            size_t dev = test_rand_range(DEV_NUM + 1);
+            unsigned long spid = test_rand_range(HYP_SPID);
+
+            if (dev == DEV_NUM) {
+                /* Devices not described by the platform are left alone */
+                TEST_ASSERT(!pbg_allow_device(0x1000, spid));
+            } else {
+                TEST_ASSERT(pbg_allow_device(devices[dev].dev_base, spid));
+                ref_allow(&devices[dev], spid);
+            }
+            check_hw();
+        }
+    }
+
+    /* Nothing but the PBGPROT1 and PBGKCPROT registers is ever written */
+    for (size_t g = 0; g < GROUP_NUM; g++) {
+        for (size_t c = 0; c < PLAT_NUM_PBG_CHANNELS; c++) {
+            channel(g, c)->PBGPROT1 = 0;
+        }
+    }
+    for (size_t n = 0; n < ERRSLV_NUM; n++) {
+        errslv(n)->PBGKCPROT = 0;
+    }
+    for (size_t i = 0; i < sizeof(pbg_test_hw); i++) {
+        TEST_ASSERT(((uint8_t*)&pbg_test_hw)[i] == 0);
+    }
+}
@@ -0,0 +1,117 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#include <test.h>
+#include <printk.h>
+#include <limits.h>
+#include <string.h>
+
+#define OUT_LEN (512)
+
+/**
+ * Prints through vsnprintk in chunks of @chunk characters, the way the console drains long
+ * messages, and returns the concatenated output.
+ */
+static size_t printk_chunked(char* out, size_t chunk, const char* fmt, ...)
+{
+    va_list args;
+    size_t len = 0;
+
+    va_start(args, fmt);
+    while (*fmt != '\0') {
+        size_t n = vsnprintk(&out[len], chunk, &fmt, &args);
+        TEST_ASSERT(n <= chunk);
+        len += n;
+        TEST_ASSERT(len < OUT_LEN);
+    }
+    va_end(args);
+    out[len] = '\0';
+
+    return len;
+}
+
+/* Takes non-const strings as the hypervisor's string.h replaces the libc prototypes */
+static void check(char* out, size_t len, char* expected)
+{
+    if (strcmp(out, expected) != 0) {
+        fprintf(stderr, "expected \"%s\", got \"%s\"\n", expected, out);
+    }
+    TEST_ASSERT(strcmp(out, expected) == 0);
+    TEST_ASSERT(len == strlen(expected));
+}
+
+static void random_string(char* str, size_t max)
+{
+    size_t len = test_rand_range(max);
+    for (size_t i = 0; i < len; i++) {
+        str[i] = (char)(' ' + 1 + test_rand_range('~' - ' '));
+        if (str[i] == '%') {
+            str[i] = '#';
+        }
+    }
+    str[len] = '\0';
+}
+
+static void test_edge_cases(void)
+{
+    char out[OUT_LEN];
+    char expected[OUT_LEN];
+    size_t len;
+
+    len = printk_chunked(out, 64, "%d %d %d %ld %ld", 0, INT_MIN, INT_MAX, LONG_MIN, LONG_MAX);
+    snprintf(expected, OUT_LEN, "%d %d %d %ld %ld", 0, INT_MIN, INT_MAX, LONG_MIN, LONG_MAX);
+    check(out, len, expected);
+
+    len = printk_chunked(out, 64, "%u %x %lu %lx %llx", UINT_MAX, UINT_MAX, ULONG_MAX, ULONG_MAX,
+        0x123456789abcdefULL);
+    snprintf(expected, OUT_LEN, "%u %x %lu %lx %llx", UINT_MAX, UINT_MAX, ULONG_MAX, ULONG_MAX,
+        0x123456789abcdefULL);
+    check(out, len, expected);
+
+    len = printk_chunked(out, 64, "%c%c%% %s|%s|", 'a', 'Z', "", "str");
+    snprintf(expected, OUT_LEN, "%c%c%% %s|%s|", 'a', 'Z', "", "str");
+    check(out, len, expected);
+}
+
+void test_run(void)
+{
+    test_edge_cases();
+
+    for (unsigned long it = 0; it < TEST_ITERATIONS; it++) {
+        char out[OUT_LEN];
+        char expected[OUT_LEN];
+        char str[24];
+        int d = (int)test_rand();
+        unsigned int u = (unsigned int)test_rand();
+        long ld = (long)test_rand();
+        unsigned long lx = test_rand() >> test_rand_range(64);
+        char c = (char)('!' + test_rand_range('~' - '!'));
+        /* The widest single argument must fit in a chunk */
+        size_t chunk = 24 + test_rand_range(64);
+
+        random_string(str, sizeof(str));
+        size_t len =
+            printk_chunked(out, chunk, "d=%d u=%u x=%x s=%s c=%c ld=%ld lx=0x%lx %%end", d, u, u,
+                str, c, ld, lx);
+        snprintf(expected, OUT_LEN, "d=%d u=%u x=%x s=%s c=%c ld=%ld lx=0x%lx %%end", d, u, u, str,
+            c, ld, lx);
+        check(out, len, expected);
+    }
+}
+
+void test_bench(void)
+{
+    char out[OUT_LEN];
+    unsigned long ops = TEST_ITERATIONS * 10;
+    volatile size_t sink = 0;
+
+    unsigned long start = test_time_ns();
+    for (unsigned long i = 0; i < ops; i++) {
+        sink += printk_chunked(out, OUT_LEN - 1, "cpu %lu: vm %d fault at 0x%lx (%s)\n", i,
+            (int)(i % 8), i * PAGE_SIZE, "data abort");
+    }
+    test_bench_report("vsnprintk typical log line", start, ops);
+    (void)sink;
+}
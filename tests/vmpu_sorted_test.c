@@ -0,0 +1,138 @@
+/**
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) Bao Project and Contributors. All rights reserved.
+ */
+
+#include <test.h>
+#include <mem_prot/vmpu_sorted.h>
+
+static struct addr_space as;
+
+/* Reference model: which entries are valid, searched linearly */
+static bool valid[VMPU_NUM_ENTRIES];
+static size_t valid_num;
+
+static size_t ref_upper(vaddr_t addr)
+{
+    size_t count = 0;
+    for (mpid_t i = 0; i < VMPU_NUM_ENTRIES; i++) {
+        if (valid[i] && as.vmpu.node[i].region.base <= addr) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static void check_index(void)
+{
+    bool seen[VMPU_NUM_ENTRIES] = { false };
+
+    TEST_ASSERT(as.vmpu.sorted_num == valid_num);
+    for (size_t i = 0; i < as.vmpu.sorted_num; i++) {
+        mpid_t mpid = as.vmpu.sorted[i];
+        TEST_ASSERT(mpid < VMPU_NUM_ENTRIES);
+        TEST_ASSERT(valid[mpid] && !seen[mpid]);
+        seen[mpid] = true;
+        if (i > 0) {
+            TEST_ASSERT(as.vmpu.node[as.vmpu.sorted[i - 1]].region.base <=
+                as.vmpu.node[mpid].region.base);
+        }
+    }
+}
+
+static vaddr_t random_base(void)
+{
+    /* A small address range, so that equal bases and exact boundary lookups are common */
+    return (vaddr_t)test_rand_range(4 * VMPU_NUM_ENTRIES) * PAGE_SIZE;
+}
+
+static mpid_t random_entry(bool is_valid)
+{
+    mpid_t first = test_rand_range(VMPU_NUM_ENTRIES);
+    for (mpid_t i = 0; i < VMPU_NUM_ENTRIES; i++) {
+        mpid_t mpid = (first + i) % VMPU_NUM_ENTRIES;
+        if (valid[mpid] == is_valid) {
+            return mpid;
+        }
+    }
+    return INVALID_MPID;
+}
+
+void test_run(void)
+{
+    as.vmpu.sorted_num = 0;
+    TEST_ASSERT(mem_vmpu_sorted_upper(&as, 0) == 0);
+
+    for (unsigned long it = 0; it < TEST_ITERATIONS; it++) {
+        /* Drift between an almost empty and an almost full vMPU */
+        unsigned long insert_pct = ((it / 1000) % 2) ? 35 : 65;
+        mpid_t mpid;
+
+        if (test_rand_range(100) < insert_pct) {
+            mpid = random_entry(false);
+            if (mpid != INVALID_MPID) {
+                as.vmpu.node[mpid].region.base = random_base();
+                mem_vmpu_sorted_insert(&as, mpid);
+                valid[mpid] = true;
+                valid_num++;
+            }
+        } else {
+            mpid = random_entry(true);
+            if (mpid != INVALID_MPID) {
+                mem_vmpu_sorted_remove(&as, mpid);
+                valid[mpid] = false;
+                valid_num--;
+            } else {
+                /* Removing an entry which is not indexed leaves the index untouched */
+                mem_vmpu_sorted_remove(&as, 0);
+            }
+        }
+        check_index();
+
+        for (size_t i = 0; i < 4; i++) {
+            vaddr_t addr = random_base() + (test_rand_range(2) ? 0 : test_rand_range(PAGE_SIZE));
+            TEST_ASSERT(mem_vmpu_sorted_upper(&as, addr) == ref_upper(addr));
+        }
+        TEST_ASSERT(mem_vmpu_sorted_upper(&as, ~(vaddr_t)0) == valid_num);
+    }
+}
+
+void test_bench(void)
+{
+    unsigned long ops = TEST_ITERATIONS * 50;
+    volatile size_t sink = 0;
+
+    as.vmpu.sorted_num = 0;
+    for (mpid_t i = 0; i < VMPU_NUM_ENTRIES; i++) {
+        valid[i] = false;
+    }
+    valid_num = 0;
+    for (mpid_t i = 0; i < VMPU_NUM_ENTRIES; i++) {
+        as.vmpu.node[i].region.base = random_base();
+        mem_vmpu_sorted_insert(&as, i);
+        valid[i] = true;
+        valid_num++;
+    }
+
+    unsigned long start = test_time_ns();
+    for (unsigned long i = 0; i < ops; i++) {
+        sink += mem_vmpu_sorted_upper(&as, (vaddr_t)(i % (4 * VMPU_NUM_ENTRIES)) * PAGE_SIZE);
+    }
+    test_bench_report("mem_vmpu_sorted_upper, full vMPU", start, ops);
+
+    start = test_time_ns();
+    for (unsigned long i = 0; i < ops; i++) {
+        sink += ref_upper((vaddr_t)(i % (4 * VMPU_NUM_ENTRIES)) * PAGE_SIZE);
+    }
+    test_bench_report("linear scan, full vMPU", start, ops);
+
+    ops = TEST_ITERATIONS * 10;
+    start = test_time_ns();
+    for (unsigned long i = 0; i < ops; i++) {
+        mpid_t mpid = i % VMPU_NUM_ENTRIES;
+        mem_vmpu_sorted_remove(&as, mpid);
+        mem_vmpu_sorted_insert(&as, mpid);
+    }
+    test_bench_report("mem_vmpu_sorted_remove+insert", start, ops);
+    (void)sink;
+}